@@ -0,0 +1,22 @@
+:: Build script for 'benchmark-hashutil'
+
+:: Requirements:
+::  - MSVC accessible via PATH
+::  - "vcvarsall.bat x64" must be executed in the shell before this script is run
+::  - This script must be run from project root folder
+
+@echo off
+
+:: NOTE: Benchmarks are always built with optimizations enabled
+set CompilerFlags=-nologo -O2 -Gm- -MT -GR- -EHa- -Oi -W4 -FC -wd4505 -wd4068 -wd4996 -wd4201 -DHASHUTIL_SLOW=0
+
+set BuildFolder=bin
+set LinkerFlags=-opt:ref -incremental:no
+
+:: Create build folder if it doesn't exist and change working directory
+IF NOT EXIST %BuildFolder% mkdir %BuildFolder%
+pushd %BuildFolder%
+
+:: Compile benchmark runner
+cl %CompilerFlags% "..\src\benchmark-hashutil.c" /link %LinkerFlags%
+popd
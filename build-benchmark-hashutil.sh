@@ -0,0 +1,23 @@
+# Build script for benchmark-hashutil.
+
+# Requirements:
+#   - clang accessible via PATH
+#   - Script executed from the project root
+
+# Save the script's folder
+SCRIPT_DIR=$( cd -- "$( dirname -- "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )
+
+# Note: Benchmarks are always built with optimizations enabled
+CompilerFlags="-O2 -DHASHUTIL_SLOW=0"
+
+BuildFolder="bin"
+
+# Create build folder if it doesn't exist
+mkdir -p "$SCRIPT_DIR/$BuildFolder"
+
+# Change to the build folder (and redirect stdout to /dev/null and the redirect stderr to stdout)
+pushd $BuildFolder > /dev/null 2>&1
+
+# Compile benchmark runner
+clang $CompilerFlags "$SCRIPT_DIR/src/benchmark-hashutil.c" -o "benchmark-hashutil"
+popd > /dev/null 2>&1
@@ -0,0 +1,46 @@
+# Build script for 'test-shared-library'
+
+# Requirements:
+#   - clang accessible via PATH
+#   - Script executed from the project root
+
+# Save the script's folder
+SCRIPT_DIR=$( cd -- "$( dirname -- "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )
+
+# Set the DEBUG environment variable to 0 if
+# it isn't already defined
+if [ -z $DEBUG ]
+then
+    DEBUG=0
+fi
+
+if [ $DEBUG = "1" ]
+then
+    # Making debug build
+    CompilerFlags="-g -DHASHUTIL_SLOW=1 -Wno-null-dereference"
+else
+    # Making release build
+    CompilerFlags="-O2 -DHASHUTIL_SLOW=0"
+fi
+
+# Note: Only the *_API functions are exported and the update kernels are bound by the dynamic loader
+LibraryFlags="-x c -shared -fPIC -fvisibility=hidden -DHASHUTIL_USE_IFUNC=1"
+
+BuildFolder="bin"
+
+# Create build folder if it doesn't exist
+mkdir -p "$SCRIPT_DIR/$BuildFolder"
+
+# Change to the build folder (and redirect stdout to /dev/null and the redirect stderr to stdout)
+pushd $BuildFolder > /dev/null 2>&1
+
+# Build the stb-style headers as shared libraries
+clang $CompilerFlags $LibraryFlags "$SCRIPT_DIR/src/md5.h" -DHASHUTIL_MD5_IMPLEMENTATION -o "libmd5.so"
+clang $CompilerFlags $LibraryFlags "$SCRIPT_DIR/src/sha1.h" -DHASHUTIL_SHA1_IMPLEMENTATION -o "libsha1.so"
+clang $CompilerFlags $LibraryFlags "$SCRIPT_DIR/src/sha2.h" -DHASHUTIL_SHA2_IMPLEMENTATION -o "libsha2.so"
+
+# Link the test driver against the libraries and look them up next to the executable
+clang $CompilerFlags "$SCRIPT_DIR/src/test-shared-library.c" -o "test-shared-library" -L. -lmd5 -lsha1 -lsha2 -Wl,-rpath,'$ORIGIN'
+./test-shared-library
+
+popd > /dev/null 2>&1
@@ -0,0 +1,230 @@
+/*  benchmark-hashutil.c
+
+    Benchmark driver for md5.h, sha1.h, sha2.h and multihash.h. Measures the throughput of the compression
+    kernels on a large in-memory buffer so that alternative implementations can be compared.
+*/
+
+#define HASHUTIL_MD5_IMPLEMENTATION
+#define HASHUTIL_MD5_INCLUDE_ALL_KERNELS 1
+#include "md5.h"
+#define HASHUTIL_SHA1_IMPLEMENTATION
+#include "sha1.h"
+#define HASHUTIL_SHA2_IMPLEMENTATION
+#include "sha2.h"
+#define HASHUTIL_MULTIHASH_IMPLEMENTATION
+#include "multihash.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Note (Aaron): Size of the buffer each kernel hashes per repetition. It is a multiple of every
+// algorithm's block size.
+#define BENCHMARK_BUFFER_SIZE (16 * 1024 * 1024)
+#define BENCHMARK_REPETITIONS 8
+
+static uint8_t *BenchmarkBuffer;
+
+
+static double GetSeconds()
+{
+    struct timespec time;
+    timespec_get(&time, TIME_UTC);
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+
+static void ReportThroughput(char const *name, double seconds)
+{
+    double megabytes = (double)BENCHMARK_BUFFER_SIZE * BENCHMARK_REPETITIONS / (1024.0 * 1024.0);
+    printf("%-32s %8.1f MB/s\n", name, megabytes / seconds);
+}
+
+
+typedef void md5_benchmark_kernel(md5_hash *state, uint8_t *ptr, uint64_t byteCount);
+
+static void BenchmarkMD5Kernel(char const *name, md5_benchmark_kernel *kernel)
+{
+    md5_context context;
+    MD5_InitializeContext(&context);
+
+    double start = GetSeconds();
+    for (int i = 0; i < BENCHMARK_REPETITIONS; ++i)
+    {
+        kernel(&context.Hash, BenchmarkBuffer, BENCHMARK_BUFFER_SIZE);
+    }
+    double elapsed = GetSeconds() - start;
+
+    MD5_ConstructDigest(&context);
+    ReportThroughput(name, elapsed);
+}
+
+
+static void PerformMD5Benchmarks()
+{
+    printf("MD5 kernels:\n");
+    BenchmarkMD5Kernel("Transform functions", MD5_UpdateHashTransforms);
+    BenchmarkMD5Kernel("Unrolled", MD5_UpdateHashUnrolled);
+    printf("\n");
+}
+
+
+typedef void sha1_benchmark_kernel(sha1_hash *state, uint8_t *messagePtr, uint64_t byteCount);
+
+static void BenchmarkSHA1Kernel(char const *name, sha1_benchmark_kernel *kernel)
+{
+    sha1_context context;
+    SHA1_InitializeContext(&context);
+
+    double start = GetSeconds();
+    for (int i = 0; i < BENCHMARK_REPETITIONS; ++i)
+    {
+        kernel(&context.Hash, BenchmarkBuffer, BENCHMARK_BUFFER_SIZE);
+    }
+    double elapsed = GetSeconds() - start;
+
+    SHA1_ConstructDigest(&context);
+    ReportThroughput(name, elapsed);
+}
+
+
+static void PerformSHA1Benchmarks()
+{
+    printf("SHA1 kernels:\n");
+    BenchmarkSHA1Kernel("Scalar", SHA1_UpdateHashScalar);
+#if SHA1_X64
+    if (SHA1_HasCPUFeatures(SHA1_CPU_FEATURE_SSSE3)) BenchmarkSHA1Kernel("SSSE3 schedule", SHA1_UpdateHashSSSE3);
+    if (SHA1_HasCPUFeatures(SHA1_CPU_FEATURE_AVX)) BenchmarkSHA1Kernel("AVX schedule", SHA1_UpdateHashAVX);
+    if (SHA1_HasCPUFeatures(SHA1_CPU_FEATURE_AVX2 | SHA1_CPU_FEATURE_BMI2)) BenchmarkSHA1Kernel("AVX2 schedule", SHA1_UpdateHashAVX2);
+    if (SHA1_HasCPUFeatures(SHA1_CPU_FEATURE_SHA | SHA1_CPU_FEATURE_SSE41 | SHA1_CPU_FEATURE_SSSE3)) BenchmarkSHA1Kernel("SHA-NI", SHA1_UpdateHashSHANI);
+#endif
+    printf("\n");
+}
+
+
+typedef void sha2_256_benchmark_kernel(sha2_256_hash *state, uint8_t *messagePtr, uint64_t byteCount);
+
+static void BenchmarkSHA256Kernel(char const *name, sha2_256_benchmark_kernel *kernel)
+{
+    sha2_256_context context;
+    SHA2_InitializeContextSHA256(&context);
+
+    double start = GetSeconds();
+    for (int i = 0; i < BENCHMARK_REPETITIONS; ++i)
+    {
+        kernel(&context.Hash, BenchmarkBuffer, BENCHMARK_BUFFER_SIZE);
+    }
+    double elapsed = GetSeconds() - start;
+
+    SHA2_ConstructDigestSHA256_(&context);
+    ReportThroughput(name, elapsed);
+}
+
+
+static void PerformSHA256Benchmarks()
+{
+    printf("SHA256 kernels:\n");
+    BenchmarkSHA256Kernel("Scalar", SHA2_UpdateHashSHA256Scalar);
+#if SHA2_X64
+    if (SHA2_HasCPUFeatures(SHA2_CPU_FEATURE_BMI1 | SHA2_CPU_FEATURE_BMI2)) BenchmarkSHA256Kernel("BMI2", SHA2_UpdateHashSHA256BMI2);
+    if (SHA2_HasCPUFeatures(SHA2_CPU_FEATURE_SSSE3)) BenchmarkSHA256Kernel("SSSE3 schedule", SHA2_UpdateHashSHA256SSSE3);
+    if (SHA2_HasCPUFeatures(SHA2_CPU_FEATURE_AVX)) BenchmarkSHA256Kernel("AVX schedule", SHA2_UpdateHashSHA256AVX);
+    if (SHA2_HasCPUFeatures(SHA2_CPU_FEATURE_AVX2 | SHA2_CPU_FEATURE_BMI2)) BenchmarkSHA256Kernel("AVX2 schedule", SHA2_UpdateHashSHA256AVX2);
+    if (SHA2_HasCPUFeatures(SHA2_CPU_FEATURE_SHA | SHA2_CPU_FEATURE_SSE41 | SHA2_CPU_FEATURE_SSSE3)) BenchmarkSHA256Kernel("SHA-NI", SHA2_UpdateHashSHA256SHANI);
+#endif
+    printf("\n");
+}
+
+
+typedef void sha2_512_benchmark_kernel(sha2_512_hash *state, uint8_t *messagePtr, uint64_t byteCount);
+
+static void BenchmarkSHA512Kernel(char const *name, sha2_512_benchmark_kernel *kernel)
+{
+    sha2_512_context context;
+    SHA2_InitializeContextSHA512(&context);
+
+    double start = GetSeconds();
+    for (int i = 0; i < BENCHMARK_REPETITIONS; ++i)
+    {
+        kernel(&context.Hash, BenchmarkBuffer, BENCHMARK_BUFFER_SIZE);
+    }
+    double elapsed = GetSeconds() - start;
+
+    SHA2_ConstructDigestSHA512_(&context);
+    ReportThroughput(name, elapsed);
+}
+
+
+static void PerformSHA512Benchmarks()
+{
+    printf("SHA512 kernels:\n");
+    BenchmarkSHA512Kernel("Scalar", SHA2_UpdateHashSHA512Scalar);
+#if SHA2_X64
+    if (SHA2_HasCPUFeatures(SHA2_CPU_FEATURE_BMI1 | SHA2_CPU_FEATURE_BMI2)) BenchmarkSHA512Kernel("BMI2", SHA2_UpdateHashSHA512BMI2);
+    if (SHA2_HasCPUFeatures(SHA2_CPU_FEATURE_AVX2 | SHA2_CPU_FEATURE_BMI2)) BenchmarkSHA512Kernel("AVX2 schedule", SHA2_UpdateHashSHA512AVX2);
+    if (SHA2_HasCPUFeatures(SHA2_CPU_FEATURE_AVX512F | SHA2_CPU_FEATURE_AVX512VL | SHA2_CPU_FEATURE_AVX2 | SHA2_CPU_FEATURE_BMI2)) BenchmarkSHA512Kernel("AVX-512 schedule", SHA2_UpdateHashSHA512AVX512);
+#endif
+    printf("\n");
+}
+
+
+typedef void multihash_benchmark_kernel(multihash_context *context, uint8_t *messagePtr, uint64_t byteCount);
+
+static void BenchmarkMultihashKernel(char const *name, multihash_benchmark_kernel *kernel)
+{
+    multihash_context context;
+    MULTIHASH_InitializeContext(&context);
+
+    double start = GetSeconds();
+    for (int i = 0; i < BENCHMARK_REPETITIONS; ++i)
+    {
+        kernel(&context, BenchmarkBuffer, BENCHMARK_BUFFER_SIZE);
+    }
+    double elapsed = GetSeconds() - start;
+
+    MD5_ConstructDigest(&context.MD5);
+    SHA1_ConstructDigest(&context.SHA1);
+    SHA2_ConstructDigestSHA256_(&context.SHA256);
+    ReportThroughput(name, elapsed);
+}
+
+
+static void PerformMultihashBenchmarks()
+{
+    printf("MD5 + SHA1 + SHA256 kernels:\n");
+    BenchmarkMultihashKernel("Separate passes", MULTIHASH_UpdateHashSeparate);
+#if MULTIHASH_X64
+    if (SHA2_HasCPUFeatures(SHA2_CPU_FEATURE_SHA | SHA2_CPU_FEATURE_SSE41 | SHA2_CPU_FEATURE_SSSE3)) BenchmarkMultihashKernel("Stitched SHA-NI", MULTIHASH_UpdateHashSHANI);
+#endif
+    printf("\n");
+}
+
+
+int main()
+{
+    BenchmarkBuffer = (uint8_t *)malloc(BENCHMARK_BUFFER_SIZE);
+    if (!BenchmarkBuffer)
+    {
+        printf("Unable to allocate the benchmark buffer\n");
+        return 1;
+    }
+
+    // Note (Aaron): Fill the buffer with a fixed pseudo-random pattern so that runs are comparable
+    uint32_t seed = 0x2545f491;
+    for (int i = 0; i < BENCHMARK_BUFFER_SIZE; ++i)
+    {
+        seed = seed * 1664525 + 1013904223;
+        BenchmarkBuffer[i] = (uint8_t)(seed >> 24);
+    }
+
+    PerformMD5Benchmarks();
+    PerformSHA1Benchmarks();
+    PerformSHA256Benchmarks();
+    PerformSHA512Benchmarks();
+    PerformMultihashBenchmarks();
+
+    free(BenchmarkBuffer);
+
+    return 0;
+}
@@ -3,6 +3,9 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
 
 #if HASHUTIL_SLOW
 #include <assert.h>
@@ -19,7 +22,7 @@
 static bool IsSystemLittleEndian()
 {
     uint32_t endianTest = 0xdeadbeef;
-    bool isLittleEndian = *(unsigned char *)&endianTest = 0xef;
+    bool isLittleEndian = (*(unsigned char *)&endianTest == 0xef);
 
     return isLittleEndian;
 }
@@ -28,62 +31,75 @@ static void *MemoryCopy(void *destPtr, void const *sourcePtr, size_t size)
 {
     hashutil_assert(size > 0);
 
-    unsigned char *source = (unsigned char *)sourcePtr;
-    unsigned char *dest = (unsigned char *)destPtr;
-    while(size--) *dest++ = *source++;
-
-    return destPtr;
+    return memcpy(destPtr, sourcePtr, size);
 }
 
-// TODO (Aaron): memset_explicit() uses this function signature and converts 'c'
-// into an unsigned char. I don't fully understand why. Investigate.
-// - [link](https://www.open-std.org/jtc1/sc22/wg14/www/docs/n2897.htm)
-// TODO (Aaron): 'memset()' may be optimized away by the compiler if the
-// object it operates on is never accessed again and can't be used to scrub
-// sensitive information from memory.
-// Look into whether or not the same thing occurs with this method.
 static void *MemorySet(uint8_t *destPtr, int c, size_t count)
 {
     hashutil_assert(count > 0);
 
-    unsigned char *dest = (unsigned char *)destPtr;
-    while(count--) *dest++ = (unsigned char)c;
+    return memset(destPtr, c, count);
+}
+
+// Note (Aaron): Byte order of the target. Every MSVC target is little endian.
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define HASHUTIL_BIG_ENDIAN 1
+#else
+#define HASHUTIL_BIG_ENDIAN 0
+#endif
 
-    return destPtr;
+static uint16_t ByteSwap16(uint16_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap16(value);
+#elif defined(_MSC_VER)
+    return _byteswap_ushort(value);
+#else
+    return (uint16_t)((value >> 8) | (value << 8));
+#endif
 }
 
-// TODO (Aaron): I should test the speed of mirroring bits this way
-// vs the method used for loading message blocks into the W[] registers
+static uint32_t ByteSwap32(uint32_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap32(value);
+#elif defined(_MSC_VER)
+    return _byteswap_ulong(value);
+#else
+    return ((value >> 24) & 0xff)
+         | ((value >> 8) & 0xff00)
+         | ((value << 8) & 0xff0000)
+         | ((value << 24) & 0xff000000);
+#endif
+}
+
+static uint64_t ByteSwap64(uint64_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap64(value);
+#elif defined(_MSC_VER)
+    return _byteswap_uint64(value);
+#else
+    return ((uint64_t)ByteSwap32((uint32_t)value) << 32) | ByteSwap32((uint32_t)(value >> 32));
+#endif
+}
 
-// TODO (Aaron): Test this
 // Swap endianness of 16 bit value
 static void MirrorBits16(uint16_t *bits)
 {
-    *bits = ((*bits >> 8) & 0xff00)
-          | ((*bits << 8) & 0xff00);
+    *bits = ByteSwap16(*bits);
 }
 
-// TODO (Aaron): Test this
 // Swap endianness of 32 bit value
 static void MirrorBits32(uint32_t *bits)
 {
-    *bits = ((*bits >> 24) & 0xff000000)
-          | ((*bits >> 8) & 0xff000000)
-          | ((*bits << 8) & 0xff000000)
-          | ((*bits << 24) & 0xff000000);
+    *bits = ByteSwap32(*bits);
 }
 
 // Swap endianness of 64 bit value
 static void MirrorBits64(uint64_t *bits)
 {
-    *bits = ((*bits >> 56) & 0xff)
-         | ((*bits >> 40) & 0xff00)
-         | ((*bits >> 24) & 0xff0000)
-         | ((*bits >> 8) & 0xff000000)
-         | ((*bits << 8) & 0xff00000000)
-         | ((*bits << 24) & 0xff0000000000)
-         | ((*bits << 40) & 0xff000000000000)
-         | ((*bits << 56) & 0xff00000000000000);
+    *bits = ByteSwap64(*bits);
 }
 
 // 32-bit Circular bit shift left
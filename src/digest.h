@@ -0,0 +1,203 @@
+/*  digest.h - Formats binary message digests as hex, base64 and base64url strings.
+
+    Do this:
+      #define HASHUTIL_DIGEST_IMPLEMENTATION
+   before you include this file in *one* C or C++ file to create the implementation.
+
+    md5.h, sha1.h and sha2.h write binary digests, so formatting is left to the caller and only
+    paid for when a string is actually needed. Each DIGEST_Format*() function writes a null
+    terminated string into a caller-provided buffer and returns its length without the terminator.
+    Use DIGEST_HEX_LENGTH(), DIGEST_BASE64_LENGTH() and DIGEST_BASE64URL_LENGTH() to size the
+    buffers; they include room for the terminator.
+
+    DIGEST_FormatBase64() pads its output with '=' as in RFC 4648 section 4. DIGEST_FormatBase64Url()
+    uses the URL and filename safe alphabet from section 5 and leaves out the padding.
+*/
+
+#ifndef HASHUTIL_DIGEST_H
+#define HASHUTIL_DIGEST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+static uint32_t const HASHUTIL_DIGEST_VERSION = 1;
+
+#define DIGEST_HEX_LENGTH(byteCount) ((byteCount) * 2 + 1)
+#define DIGEST_BASE64_LENGTH(byteCount) ((((byteCount) + 2) / 3) * 4 + 1)
+#define DIGEST_BASE64URL_LENGTH(byteCount) (((byteCount) * 4 + 2) / 3 + 1)
+
+// Note (Aaron): Exported from shared library builds that use -fvisibility=hidden
+#if !defined(DIGEST_API)
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(_WIN32)
+#define DIGEST_API __attribute__((visibility("default")))
+#else
+#define DIGEST_API
+#endif
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+DIGEST_API uint32_t DIGEST_GetVersion();
+DIGEST_API size_t DIGEST_FormatHex(uint8_t const *digestPtr, size_t byteCount, char *str);
+DIGEST_API size_t DIGEST_FormatBase64(uint8_t const *digestPtr, size_t byteCount, char *str);
+DIGEST_API size_t DIGEST_FormatBase64Url(uint8_t const *digestPtr, size_t byteCount, char *str);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HASHUTIL_DIGEST_H
+// end of header file ////////////////////////////////////////////////////////
+
+
+#ifdef HASHUTIL_DIGEST_IMPLEMENTATION
+
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Note (Aaron): Both hex digits of every byte value, so each input byte costs one table load and
+// one two byte copy instead of two nibble lookups.
+static char const DIGEST_HexPairs[] =
+    "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"
+    "202122232425262728292a2b2c2d2e2f303132333435363738393a3b3c3d3e3f"
+    "404142434445464748494a4b4c4d4e4f505152535455565758595a5b5c5d5e5f"
+    "606162636465666768696a6b6c6d6e6f707172737475767778797a7b7c7d7e7f"
+    "808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f"
+    "a0a1a2a3a4a5a6a7a8a9aaabacadaeafb0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
+    "c0c1c2c3c4c5c6c7c8c9cacbcccdcecfd0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
+    "e0e1e2e3e4e5e6e7e8e9eaebecedeeeff0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+
+static char const DIGEST_Base64Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+static char const DIGEST_Base64UrlAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+
+uint32_t DIGEST_GetVersion()
+{
+    uint32_t result = HASHUTIL_DIGEST_VERSION;
+    return result;
+}
+
+
+size_t DIGEST_FormatHex(uint8_t const *digestPtr, size_t byteCount, char *str)
+{
+    for (size_t i = 0; i < byteCount; ++i)
+    {
+        memcpy(str + (i * 2), DIGEST_HexPairs + (digestPtr[i] * 2), 2);
+    }
+
+    str[byteCount * 2] = '\0';
+    return byteCount * 2;
+}
+
+
+// Encodes every whole 3 byte group as 4 characters, then the 1 or 2 remaining bytes as 2 or 3
+// characters followed by optional padding
+static size_t DIGEST_FormatBase64_(uint8_t const *digestPtr, size_t byteCount, char *str,
+                                   char const *alphabet, bool usePadding)
+{
+    char *strPtr = str;
+
+    size_t i = 0;
+    for (; i + 3 <= byteCount; i += 3)
+    {
+        uint32_t group = ((uint32_t)digestPtr[i] << 16) | ((uint32_t)digestPtr[i+1] << 8) | digestPtr[i+2];
+        *strPtr++ = alphabet[(group >> 18) & 0x3f];
+        *strPtr++ = alphabet[(group >> 12) & 0x3f];
+        *strPtr++ = alphabet[(group >> 6) & 0x3f];
+        *strPtr++ = alphabet[group & 0x3f];
+    }
+
+    size_t remainderByteCount = byteCount - i;
+    if (remainderByteCount > 0)
+    {
+        uint32_t group = (uint32_t)digestPtr[i] << 16;
+        if (remainderByteCount == 2)
+        {
+            group |= (uint32_t)digestPtr[i+1] << 8;
+        }
+
+        *strPtr++ = alphabet[(group >> 18) & 0x3f];
+        *strPtr++ = alphabet[(group >> 12) & 0x3f];
+        if (remainderByteCount == 2)
+        {
+            *strPtr++ = alphabet[(group >> 6) & 0x3f];
+        }
+        else if (usePadding)
+        {
+            *strPtr++ = '=';
+        }
+
+        if (usePadding)
+        {
+            *strPtr++ = '=';
+        }
+    }
+
+    *strPtr = '\0';
+    return (size_t)(strPtr - str);
+}
+
+
+size_t DIGEST_FormatBase64(uint8_t const *digestPtr, size_t byteCount, char *str)
+{
+    return DIGEST_FormatBase64_(digestPtr, byteCount, str, DIGEST_Base64Alphabet, true);
+}
+
+
+size_t DIGEST_FormatBase64Url(uint8_t const *digestPtr, size_t byteCount, char *str)
+{
+    return DIGEST_FormatBase64_(digestPtr, byteCount, str, DIGEST_Base64UrlAlphabet, false);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HASHUTIL_DIGEST_IMPLEMENTATION
+/*
+------------------------------------------------------------------------------
+This software is available under 2 licenses -- choose whichever you prefer.
+------------------------------------------------------------------------------
+ALTERNATIVE A - MIT License
+Copyright (c) 2023 Aaron Hnyduik
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+------------------------------------------------------------------------------
+ALTERNATIVE B - Public Domain (www.unlicense.org)
+This is free and unencumbered software released into the public domain.
+Anyone is free to copy, modify, publish, use, compile, sell, or distribute this
+software, either in source code form or as a compiled binary, for any purpose,
+commercial or non-commercial, and by any means.
+In jurisdictions that recognize copyright laws, the author or authors of this
+software dedicate any and all copyright interest in the software to the public
+domain. We make this dedication for the benefit of the public at large and to
+the detriment of our heirs and successors. We intend this dedication to be an
+overt act of relinquishment in perpetuity of all present and future rights to
+this software under copyright law.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------
+*/
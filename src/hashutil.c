@@ -20,6 +20,10 @@
 #include "sha1.h"
 #define HASHUTIL_SHA2_IMPLEMENTATION
 #include "sha2.h"
+#define HASHUTIL_MULTIHASH_IMPLEMENTATION
+#include "multihash.h"
+#define HASHUTIL_DIGEST_IMPLEMENTATION
+#include "digest.h"
 
 #include "common.c"
 
@@ -27,6 +31,11 @@
 #include <string.h>
 #include <stdlib.h>
 
+#if defined(_WIN32)
+#include <io.h>
+#include <fcntl.h>
+#endif
+
 
 static char *HashAlgorithmMnemonics[] =
 {
@@ -59,11 +68,22 @@ typedef enum hash_algorithm
 } hash_algorithm;
 
 
+typedef enum output_format
+{
+    output_hex,
+    output_binary,
+    output_base64,
+    output_base64url,
+} output_format;
+
+
 typedef struct arguments
 {
     bool usageFlag;
     bool listFlag;
+    bool kernelsFlag;
     bool fileFlag;
+    output_format outputFormat;
     bool algorithmConsumed;
     bool messageConsumed;
     char *algorithmPtr;
@@ -97,7 +117,7 @@ char *GetHashMenemonic(hash_algorithm algorithm)
 
 static void PrintUsage()
 {
-    printf("usage: hashutil [-l -f -h] algorithm message\n\n");
+    printf("usage: hashutil [-l -k -f -b -h] algorithm message\n\n");
     printf("Produces a message or file digest using various hashing algorithms.\n\n");
 
     printf("positional arguments:\n");
@@ -107,7 +127,11 @@ static void PrintUsage()
 
     printf("options:\n");
     printf("-l, --list\t\tList all supported hashing algorithms\n");
+    printf("-k, --kernels\t\tList the hashing kernels selected for this CPU\n");
     printf("-f, --file\t\tHashes a file. Message is treated as a path\n");
+    printf("-b, --binary\t\tWrites only the raw digest bytes to stdout\n");
+    printf("--base64\t\tPrints the digest in base64 instead of hex\n");
+    printf("--base64url\t\tPrints the digest in unpadded base64url instead of hex\n");
     printf("-h, --help\t\tPrints these usage instructions\n");
     printf("\n");
 }
@@ -127,6 +151,23 @@ static void PrintSupportedAlgorithms()
 }
 
 
+static void PrintSelectedKernels()
+{
+    printf("Kernels selected:\n");
+    printf("  md5\t\t\t%s\n", MD5_GetKernelName());
+    printf("  sha1\t\t\t%s\n", SHA1_GetKernelName());
+    printf("  sha224 sha256\t\t%s\n", SHA2_GetKernelNameSHA256());
+    printf("  sha384 sha512 ...\t%s\n", SHA2_GetKernelNameSHA512());
+    printf("  md5+sha1+sha256\t%s\n", MULTIHASH_GetKernelName());
+
+    char const *forcedKernel = getenv("HASHUTIL_FORCE_KERNEL");
+    if (forcedKernel && forcedKernel[0])
+    {
+        printf("HASHUTIL_FORCE_KERNEL is set to '%s'\n", forcedKernel);
+    }
+}
+
+
 static void PrintErrorAndExit(char *errorStr)
 {
     printf("ERROR: %s\n", errorStr);
@@ -142,7 +183,9 @@ void ParseArgs(int argc, char const *argv[], arguments *arguments)
 
     arguments->usageFlag = false;
     arguments->listFlag = false;
+    arguments->kernelsFlag = false;
     arguments->fileFlag = false;
+    arguments->outputFormat = output_hex;
     arguments->algorithmPtr = (char *)"";
     arguments->messagePtr = (char *)"";
 
@@ -160,6 +203,12 @@ void ParseArgs(int argc, char const *argv[], arguments *arguments)
             break;
         }
 
+        if ((strncmp(argv[i], "-k", 2) == 0) || (strncmp(argv[i], "--kernels", 9) == 0))
+        {
+            arguments->kernelsFlag = true;
+            break;
+        }
+
         if (strcmp(argv[i], "--") == 0)
         {
             processOptionalArgs = false;
@@ -173,6 +222,26 @@ void ParseArgs(int argc, char const *argv[], arguments *arguments)
             continue;
         }
 
+        // Note (Aaron): Options are matched by prefix, so --base64url has to be checked before --base64
+        if (processOptionalArgs && (strncmp(argv[i], "--base64url", 11) == 0))
+        {
+            arguments->outputFormat = output_base64url;
+            continue;
+        }
+
+        if (processOptionalArgs && (strncmp(argv[i], "--base64", 8) == 0))
+        {
+            arguments->outputFormat = output_base64;
+            continue;
+        }
+
+        if (processOptionalArgs
+            && ((strncmp(argv[i], "-b", 2) == 0) || (strncmp(argv[i], "--binary", 8) == 0)))
+        {
+            arguments->outputFormat = output_binary;
+            continue;
+        }
+
         if (!algorithmConsumed)
         {
             // TODO (Aaron): What kind of sanitization do I need to do to this input?
@@ -209,6 +278,12 @@ int main(int argc, char const *argv[])
         return 0;
     }
 
+    if (arguments.kernelsFlag)
+    {
+        PrintSelectedKernels();
+        return 0;
+    }
+
     // Error out on missing or invalid arguments
     if (strlen(arguments.algorithmPtr) == 0)
     {
@@ -226,12 +301,18 @@ int main(int argc, char const *argv[])
 
     // Control flow on the selected algorithm and hash
     hash_algorithm algorithm = GetHashAlgorithm(arguments.algorithmPtr);
-    printf("%s %s\t: %s\n",
-        GetHashMenemonic(algorithm),
-        arguments.fileFlag ? "[file]" : "[string]",
-        arguments.messagePtr);
 
-    char *digest;
+    // Note (Aaron): Binary output is meant to be piped, so it is not preceded by a description
+    if (arguments.outputFormat != output_binary)
+    {
+        printf("%s %s\t: %s\n",
+            GetHashMenemonic(algorithm),
+            arguments.fileFlag ? "[file]" : "[string]",
+            arguments.messagePtr);
+    }
+
+    uint8_t digest[64];
+    size_t digestByteCount;
     switch (algorithm)
     {
         case hash_md5:
@@ -251,7 +332,8 @@ int main(int argc, char const *argv[])
                 PrintErrorAndExit(context.ErrorStr);
             }
 
-            digest = context.DigestStr;
+            digestByteCount = sizeof(context.Digest);
+            memcpy(digest, context.Digest, digestByteCount);
             break;
         }
         case hash_sha1:
@@ -271,7 +353,8 @@ int main(int argc, char const *argv[])
                 PrintErrorAndExit(context.ErrorStr);
             }
 
-            digest = context.DigestStr;
+            digestByteCount = sizeof(context.Digest);
+            memcpy(digest, context.Digest, digestByteCount);
             break;
         }
         case hash_sha224:
@@ -291,7 +374,8 @@ int main(int argc, char const *argv[])
                 PrintErrorAndExit(context.ErrorStr);
             }
 
-            digest = context.DigestStr;
+            digestByteCount = context.Hash.DigestLength / 8;
+            memcpy(digest, context.Digest, digestByteCount);
             break;
         }
         case hash_sha256:
@@ -311,7 +395,8 @@ int main(int argc, char const *argv[])
                 PrintErrorAndExit(context.ErrorStr);
             }
 
-            digest = context.DigestStr;
+            digestByteCount = context.Hash.DigestLength / 8;
+            memcpy(digest, context.Digest, digestByteCount);
             break;
         }
         case hash_sha512_224:
@@ -331,7 +416,8 @@ int main(int argc, char const *argv[])
                 PrintErrorAndExit(context.ErrorStr);
             }
 
-            digest = context.DigestStr;
+            digestByteCount = context.Hash.DigestLength / 8;
+            memcpy(digest, context.Digest, digestByteCount);
             break;
         }
         case hash_sha512_256:
@@ -351,7 +437,8 @@ int main(int argc, char const *argv[])
                 PrintErrorAndExit(context.ErrorStr);
             }
 
-            digest = context.DigestStr;
+            digestByteCount = context.Hash.DigestLength / 8;
+            memcpy(digest, context.Digest, digestByteCount);
             break;
         }
         case hash_sha384:
@@ -371,7 +458,8 @@ int main(int argc, char const *argv[])
                 PrintErrorAndExit(context.ErrorStr);
             }
 
-            digest = context.DigestStr;
+            digestByteCount = context.Hash.DigestLength / 8;
+            memcpy(digest, context.Digest, digestByteCount);
             break;
         }
         case hash_sha512:
@@ -391,7 +479,8 @@ int main(int argc, char const *argv[])
                 PrintErrorAndExit(context.ErrorStr);
             }
 
-            digest = context.DigestStr;
+            digestByteCount = context.Hash.DigestLength / 8;
+            memcpy(digest, context.Digest, digestByteCount);
             break;
         }
         default:
@@ -401,6 +490,33 @@ int main(int argc, char const *argv[])
         }
     }
 
-    printf("%s\n", digest);
+    char digestStr[DIGEST_HEX_LENGTH(64)];
+    switch (arguments.outputFormat)
+    {
+        case output_binary:
+        {
+#if defined(_WIN32)
+            _setmode(_fileno(stdout), _O_BINARY);
+#endif
+            fwrite(digest, sizeof(uint8_t), digestByteCount, stdout);
+            return 0;
+        }
+        case output_base64:
+        {
+            DIGEST_FormatBase64(digest, digestByteCount, digestStr);
+            break;
+        }
+        case output_base64url:
+        {
+            DIGEST_FormatBase64Url(digest, digestByteCount, digestStr);
+            break;
+        }
+        default:
+        {
+            DIGEST_FormatHex(digest, digestByteCount, digestStr);
+        }
+    }
+
+    printf("%s\n", digestStr);
     return 0;
 }
@@ -1,5 +1,4 @@
 /* TODO (Aaron):
-    - Profile the time taken hashing a large file using methods vs defines
     - Add platform layer for working with files
 */
 
@@ -8,6 +7,39 @@
     Do this:
       #define HASHUTIL_MD5_IMPLEMENTATION
    before you include this file in *one* C or C++ file to create the implementation.
+
+    Messages that arrive in pieces can be hashed by calling MD5_Init() once, MD5_Update()
+    for each piece and MD5_Final() to write the digest into the context.
+
+    When hashing many small messages, use MD5_DigestBuffer() or MD5_InitState(), MD5_UpdateState()
+    and MD5_FinalState() instead. They work on the compact md5_state and write the binary digest,
+    and optionally its hex string, into buffers provided by the caller.
+
+    An in-progress hash can be saved with MD5_ExportState() and resumed with MD5_ImportState(),
+    also in another process or on another platform. The exported bytes have a fixed, versioned,
+    little endian layout and include any buffered message bytes. Both functions work on the Hash
+    member of an md5_state or an md5_context.
+
+    Many independent messages can be hashed in one call with MD5_HashBuffers(). On CPUs
+    with AVX2 or AVX-512 the messages are hashed side by side, one message per vector lane.
+
+    Single messages are hashed with a fully unrolled kernel. Define
+      HASHUTIL_MD5_USE_TRANSFORM_FUNCTIONS
+    to hash them with the MD5_TransformFF()..MD5_TransformII() functions instead. Define
+      HASHUTIL_MD5_INCLUDE_ALL_KERNELS
+    to compile both scalar kernels, MD5_UpdateHashTransforms() and MD5_UpdateHashUnrolled(),
+    whichever one is the default.
+
+    Kernels are picked once at runtime from the CPU's features. Set the HASHUTIL_FORCE_KERNEL
+    environment variable to "scalar", "avx2" or "avx512" to restrict hashing to that kernel.
+    Names the CPU or this header does not support fall back to the default choice.
+    MD5_GetKernelName() returns the name of the kernel used for single messages.
+
+    To build the implementation into a shared library, compile it with -fvisibility=hidden so
+    only the MD5_API functions are exported. On ELF targets, additionally define
+      HASHUTIL_USE_IFUNC
+    to have the dynamic loader select the kernel once when the library is loaded. Such builds
+    ignore HASHUTIL_FORCE_KERNEL since the loader selects kernels before the environment is set up.
 */
 
 #ifndef HASHUTIL_MD5_H
@@ -15,27 +47,116 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 static uint32_t const HASHUTIL_MD5_VERSION = 1;
 
+// Note (Aaron): Aligns a struct member, and with it the struct, to the given byte boundary
+#if !defined(MD5_ALIGN)
+#if defined(_MSC_VER) && !defined(__clang__)
+#define MD5_ALIGN(n) __declspec(align(n))
+#else
+#define MD5_ALIGN(n) __attribute__((aligned(n)))
+#endif
+#endif
+
+#define MD5_DIGEST_SIZE 16
+
+// Note (Aaron): Size of a state written by MD5_ExportState(). The layout is fixed for a given
+// MD5_STATE_FORMAT_VERSION, with every integer stored little endian like the MD5 digest itself:
+//   0   4 bytes   "MD5\0"
+//   4   uint32    MD5_STATE_FORMAT_VERSION
+//   8   uint32    Digest length in bits (128)
+//   12  uint32    State[0..3]
+//   28  uint64    Message length in bits
+//   36  uint32    Number of buffered message bytes
+//   40  64 bytes  Buffered message bytes, zero padded
+#define MD5_STATE_FORMAT_VERSION 1
+#define MD5_EXPORTED_STATE_SIZE 104
+
+typedef enum
+{
+    MD5_RESULT_OK = 0,
+    MD5_RESULT_INVALID_STATE = 1,
+} md5_result;
+
+// Note (Aaron): Everything the kernels touch while hashing. The message block comes first and
+// fills exactly one cache line, so nothing needs padding and the struct stays at 96 bytes when
+// it is embedded in an md5_context.
 typedef struct
 {
-    uint32_t MessageLengthBits;
+    // Note (Aaron): Holds message bytes passed to MD5_Update() that do not yet fill
+    // a 512 bit message block.
+    uint8_t MessageBlock[64];
+
     uint32_t State[4];
-    uint8_t Digest[16];
+    uint64_t MessageLengthBits;
+
+    uint32_t MessageBlockByteCount;
+
+    // Note (Aaron): Set to true after MD5_Init() or MD5_InitState() to skip zeroing message data
+    // and intermediate state once it has been hashed. Only worth it for bulk hashing of non-secret data.
+    bool DisableScrubbing;
+} md5_hash;
+
+// Note (Aaron): Standalone state for the MD5_*State() functions. It sits on a 64 byte boundary,
+// which puts the message block and the chaining state on cache lines of their own. Heap allocated
+// states need an aligned allocator such as aligned_alloc().
+typedef struct
+{
+    MD5_ALIGN(64) md5_hash Hash;
+} md5_state;
+
+typedef struct
+{
+    md5_hash Hash;
+
+    uint8_t Digest[MD5_DIGEST_SIZE];
     char DigestStr[33];
     bool Error;
     char ErrorStr[64];
 } md5_context;
 
 
+// Note (Aaron): Public functions keep default visibility so that the implementation can be built
+// into a shared library with -fvisibility=hidden without exporting its internals.
+#if !defined(MD5_API)
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(_WIN32)
+#define MD5_API __attribute__((visibility("default")))
+#else
+#define MD5_API
+#endif
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-uint32_t MD5_GetVersion();
-md5_context MD5_HashString(char *messagePtr);
-md5_context MD5_HashFile(const char *fileName);
+MD5_API uint32_t MD5_GetVersion();
+MD5_API char const *MD5_GetKernelName();
+MD5_API md5_context MD5_HashString(char *messagePtr);
+MD5_API md5_context MD5_HashFile(const char *fileName);
+MD5_API md5_context MD5_HashBuffer(void const *messagePtr, size_t byteCount);
+MD5_API void MD5_HashBuffers(md5_context *contexts, void const * const *messagePtrs, size_t const *byteCounts, size_t count);
+
+MD5_API void MD5_Init(md5_context *context);
+MD5_API void MD5_Update(md5_context *context, void const *messagePtr, size_t byteCount);
+MD5_API void MD5_Final(md5_context *context);
+
+// Note (Aaron): Hashes through a bare md5_state and writes the digest to caller-provided buffers,
+// which avoids copying whole contexts around and formatting strings nobody reads. digestPtr
+// receives MD5_DIGEST_SIZE bytes. digestStr is optional and receives 2 * MD5_DIGEST_SIZE + 1 chars.
+MD5_API void MD5_InitState(md5_state *state);
+MD5_API void MD5_UpdateState(md5_state *state, void const *messagePtr, size_t byteCount);
+MD5_API void MD5_FinalState(md5_state *state, uint8_t *digestPtr, char *digestStr);
+MD5_API void MD5_DigestBuffer(void const *messagePtr, size_t byteCount, uint8_t *digestPtr, char *digestStr);
+
+// Note (Aaron): Saves an in-progress hash into MD5_EXPORTED_STATE_SIZE bytes so it can be resumed
+// later or in another process, on any platform. The buffered message bytes are part of the export,
+// so treat it like the message itself. MD5_ImportState() rejects buffers with the wrong format or
+// version, or inconsistent counts, and resets DisableScrubbing to false.
+MD5_API void MD5_ExportState(md5_hash const *state, uint8_t *bufferPtr);
+MD5_API md5_result MD5_ImportState(md5_hash *state, uint8_t const *bufferPtr);
 
 #ifdef __cplusplus
 }
@@ -48,6 +169,8 @@ md5_context MD5_HashFile(const char *fileName);
 #ifdef HASHUTIL_MD5_IMPLEMENTATION
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <stdbool.h>
 
 #if HASHUTIL_SLOW
@@ -63,6 +186,46 @@ md5_context MD5_HashFile(const char *fileName);
 
 #define MD5_MESSAGE_BLOCK_SIZE 64
 #define MD5_MESSAGE_LENGTH_BLOCK_SHA256 8
+#define MD5_FILE_READ_BLOCK_COUNT 64
+
+// Note (Aaron): Hardware accelerated kernels are only built for x86-64. Define
+// HASHUTIL_DISABLE_SIMD to build the portable scalar kernels only.
+#if !defined(HASHUTIL_DISABLE_SIMD) && (defined(__x86_64__) || defined(_M_X64))
+#define MD5_X64 1
+#else
+#define MD5_X64 0
+#endif
+
+// Note (Aaron): Byte order of the target. Every MSVC target is little endian.
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define MD5_BIG_ENDIAN 1
+#else
+#define MD5_BIG_ENDIAN 0
+#endif
+
+#if MD5_X64
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define MD5_TARGET(features)
+#else
+#include <cpuid.h>
+#define MD5_TARGET(features) __attribute__((target(features)))
+#endif
+#include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+// Note (Aaron): Define HASHUTIL_USE_IFUNC to bind the update kernels through GNU indirect functions.
+// The dynamic loader then selects the kernel once at load time instead of every update checking the
+// cached selection. Only available for ELF targets.
+#if HASHUTIL_USE_IFUNC && defined(__ELF__) && (defined(__GNUC__) || defined(__clang__))
+#define MD5_USE_IFUNC 1
+#else
+#define MD5_USE_IFUNC 0
+#endif
 
 
 #ifdef __cplusplus
@@ -76,15 +239,139 @@ uint32_t MD5_GetVersion()
 }
 
 
+// Note (Aaron): The lazily computed caches below are each a single word that is loaded and stored
+// atomically, so a thread racing the first call sees either the "not computed" value or the
+// complete result, never one without the other.
+#if MD5_X64
+static uint32_t MD5_AtomicLoad32(uint32_t *ptr)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+#elif defined(_MSC_VER)
+    return (uint32_t)_InterlockedOr((long volatile *)ptr, 0);
+#else
+    return *(uint32_t volatile *)ptr;
+#endif
+}
+
+static void MD5_AtomicStore32(uint32_t *ptr, uint32_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+#elif defined(_MSC_VER)
+    _InterlockedExchange((long volatile *)ptr, (long)value);
+#else
+    *(uint32_t volatile *)ptr = value;
+#endif
+}
+#endif
+
+static void const *MD5_AtomicLoadPointer(void const **ptr)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+#elif defined(_MSC_VER)
+    return _InterlockedCompareExchangePointer((void * volatile *)ptr, 0, 0);
+#else
+    return *(void const * volatile *)ptr;
+#endif
+}
+
+static void MD5_AtomicStorePointer(void const **ptr, void const *value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+#elif defined(_MSC_VER)
+    _InterlockedExchangePointer((void * volatile *)ptr, (void *)value);
+#else
+    *(void const * volatile *)ptr = value;
+#endif
+}
+
+
+#if MD5_X64
+typedef enum
+{
+    MD5_CPU_FEATURE_AVX2 = (1 << 0),
+    MD5_CPU_FEATURE_AVX512F = (1 << 1),
+} md5_cpu_feature;
+
+// Note (Aaron): Set in the cached CPU features once CPUID has been queried
+#define MD5_CPU_FEATURES_QUERIED 0x80000000u
+
+
+static void MD5_CPUID(uint32_t leaf, uint32_t subleaf, uint32_t registers[4])
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    __cpuidex((int *)registers, (int)leaf, (int)subleaf);
+#else
+    __cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+}
+
+
+MD5_TARGET("xsave")
+static uint64_t MD5_XGETBV(uint32_t index)
+{
+    return _xgetbv(index);
+}
+
+
+static uint32_t MD5_GetCPUFeatures()
+{
+    // Note (Aaron): CPUID is only queried once. Racing threads compute the same value, and the
+    // cached result only counts once MD5_CPU_FEATURES_QUERIED is set in the same word.
+    static uint32_t features = 0;
+
+    uint32_t cachedFeatures = MD5_AtomicLoad32(&features);
+    if (cachedFeatures & MD5_CPU_FEATURES_QUERIED)
+    {
+        return cachedFeatures & ~MD5_CPU_FEATURES_QUERIED;
+    }
+
+    uint32_t result = 0;
+    uint32_t registers[4] = {0};
+
+    MD5_CPUID(0, 0, registers);
+    uint32_t maxLeaf = registers[0];
+
+    MD5_CPUID(1, 0, registers);
+
+    // Note (Aaron): AVX registers are only usable when the OS saves them on context switches
+    bool osSavesYMM = false;
+    bool osSavesZMM = false;
+    if (registers[2] & (1 << 27))
+    {
+        uint64_t enabledStates = MD5_XGETBV(0);
+        osSavesYMM = (enabledStates & 0x06) == 0x06;
+        osSavesZMM = (enabledStates & 0xe6) == 0xe6;
+    }
+
+    if (maxLeaf >= 7)
+    {
+        MD5_CPUID(7, 0, registers);
+        if ((registers[1] & (1 << 5)) && osSavesYMM) result |= MD5_CPU_FEATURE_AVX2;
+        if ((registers[1] & (1 << 16)) && osSavesZMM) result |= MD5_CPU_FEATURE_AVX512F;
+    }
+
+    MD5_AtomicStore32(&features, result | MD5_CPU_FEATURES_QUERIED);
+
+    return result;
+}
+
+
+static bool MD5_HasCPUFeatures(uint32_t requiredFeatures)
+{
+    return (MD5_GetCPUFeatures() & requiredFeatures) == requiredFeatures;
+}
+#endif
+
+
 static void *MD5_MemoryCopy(void *destPtr, void const *sourcePtr, size_t size)
 {
     md5_assert(size > 0);
 
-    unsigned char *source = (unsigned char *)sourcePtr;
-    unsigned char *dest = (unsigned char *)destPtr;
-    while(size--) *dest++ = *source++;
-
-    return destPtr;
+    return memcpy(destPtr, sourcePtr, size);
 }
 
 
@@ -92,22 +379,105 @@ static void *MD5_MemorySet(uint8_t *destPtr, int c, size_t count)
 {
     md5_assert(count > 0);
 
-    unsigned char *dest = (unsigned char *)destPtr;
-    while(count--) *dest++ = (unsigned char)c;
+    return memset(destPtr, c, count);
+}
+
 
-    return destPtr;
+// Zeroes memory that held message data or hash state. Unlike a plain memset(), the compiler
+// does not remove it when the memory is never read again.
+static void MD5_SecureZero(void *destPtr, size_t size)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    memset(destPtr, 0, size);
+    // Note (Aaron): The empty asm statement claims to read the zeroed memory so the memset() is kept
+    __asm__ __volatile__("" : : "r"(destPtr) : "memory");
+#else
+    volatile uint8_t *dest = (volatile uint8_t *)destPtr;
+    while (size--) *dest++ = 0;
+#endif
 }
 
 
-static void MD5_InitializeContext(md5_context *context)
+static uint32_t MD5_ByteSwap32(uint32_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap32(value);
+#elif defined(_MSC_VER)
+    return _byteswap_ulong(value);
+#else
+    return ((value >> 24) & 0xff)
+         | ((value >> 8) & 0xff00)
+         | ((value << 8) & 0xff0000)
+         | ((value << 24) & 0xff000000);
+#endif
+}
+
+
+static uint64_t MD5_ByteSwap64(uint64_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap64(value);
+#elif defined(_MSC_VER)
+    return _byteswap_uint64(value);
+#else
+    return ((uint64_t)MD5_ByteSwap32((uint32_t)value) << 32) | MD5_ByteSwap32((uint32_t)(value >> 32));
+#endif
+}
+
+
+// Note (Aaron): memcpy() keeps the loads and stores safe for unaligned pointers. Compilers emit a
+// single load or store per word, plus a bswap on big-endian targets.
+static uint32_t MD5_LoadLE32(uint8_t const *ptr)
+{
+    uint32_t value;
+    memcpy(&value, ptr, sizeof(value));
+    return MD5_BIG_ENDIAN ? MD5_ByteSwap32(value) : value;
+}
+
+
+static uint64_t MD5_LoadLE64(uint8_t const *ptr)
+{
+    uint64_t value;
+    memcpy(&value, ptr, sizeof(value));
+    return MD5_BIG_ENDIAN ? MD5_ByteSwap64(value) : value;
+}
+
+
+static void MD5_StoreLE32(uint8_t *ptr, uint32_t value)
+{
+    value = MD5_BIG_ENDIAN ? MD5_ByteSwap32(value) : value;
+    memcpy(ptr, &value, sizeof(value));
+}
+
+
+static void MD5_StoreLE64(uint8_t *ptr, uint64_t value)
+{
+    value = MD5_BIG_ENDIAN ? MD5_ByteSwap64(value) : value;
+    memcpy(ptr, &value, sizeof(value));
+}
+
+
+static void MD5_InitializeState(md5_hash *state)
 {
-    context->MessageLengthBits = 0;
+    state->MessageLengthBits = 0;
+
+    state->State[0] = 0x67452301;
+    state->State[1] = 0xefcdab89;
+    state->State[2] = 0x98badcfe;
+    state->State[3] = 0x10325476;
+
+    state->MessageBlockByteCount = 0;
+    state->DisableScrubbing = false;
+
+#if HASHUTIL_SLOW
+    MD5_MemorySet(state->MessageBlock, 0, sizeof(state->MessageBlock));
+#endif
+}
 
-    context->State[0] = 0x67452301;
-    context->State[1] = 0xefcdab89;
-    context->State[2] = 0x98badcfe;
-    context->State[3] = 0x10325476;
 
+static void MD5_InitializeContext(md5_context *context)
+{
+    MD5_InitializeState(&context->Hash);
     context->Error = false;
 
 #if HASHUTIL_SLOW
@@ -118,6 +488,9 @@ static void MD5_InitializeContext(md5_context *context)
 }
 
 
+// Note (Aaron): Only the default scalar kernel is compiled unless HASHUTIL_MD5_INCLUDE_ALL_KERNELS
+// is defined, which the test and benchmark drivers do to compare the two
+#if HASHUTIL_MD5_USE_TRANSFORM_FUNCTIONS || HASHUTIL_MD5_INCLUDE_ALL_KERNELS
 // 32-bit Circular bit shift left
 static uint32_t MD5_ROTL(uint32_t value, uint8_t count)
 {
@@ -197,7 +570,7 @@ static uint32_t MD5_TransformII(uint32_t A, uint32_t B, uint32_t C, uint32_t D,
 }
 
 
-static void MD5_UpdateHash(md5_context *context, uint8_t *ptr, uint64_t byteCount)
+static void MD5_UpdateHashTransforms(md5_hash *state, uint8_t *ptr, uint64_t byteCount)
 {
     md5_assert(byteCount % MD5_MESSAGE_BLOCK_SIZE == 0);
 
@@ -208,30 +581,18 @@ static void MD5_UpdateHash(md5_context *context, uint8_t *ptr, uint64_t byteCoun
 
     // Iterate over blocks of the message
     // 'i' holds the current block's byte position in the message
-    for (uint32_t i = 0; i < (byteCount); i+=MD5_MESSAGE_BLOCK_SIZE)
+    for (uint64_t i = 0; i < (byteCount); i+=MD5_MESSAGE_BLOCK_SIZE)
     {
         // 'j' holds the word position from the start of the current block being processed
         for (int j = 0; j < MD5_ArrayCount(block); ++j)
         {
-            // Convert from memory-order to message order. SHA256 is processed in 32bit words.
-            // If it used 8-bit blocks, there would be no need to re-order the message chunks.
-            // TODO (Aaron): I don't think this will work regardless of endiannness. Explore.
-            // TODO (Aaron): Use a mirror bits function here instead
-            block[j] = (uint32_t)(*(ptr + i + (j * 4)))
-                | (uint32_t)(*(ptr + i + (j * 4) + 1) << 8)
-                | (uint32_t)(*(ptr + i + (j * 4) + 2) << 16)
-                | (uint32_t)(*(ptr + i + (j * 4) + 3) << 24);
-
-            // Note (Aaron): This will only work on little-endian systems (with no alignment restrictions)
-            // uint32_t endianness = 0xdeadbeef;
-            // md5_assert((*(unsigned char *)&endianness) == 0xef)
-            // block[j] = *(uint32_t *)((context->MessagePtr + i + (j * 4)));
+            block[j] = MD5_LoadLE32(ptr + i + (j * 4));
         }
 
-        uint32_t A = context->State[0];
-        uint32_t B = context->State[1];
-        uint32_t C = context->State[2];
-        uint32_t D = context->State[3];
+        uint32_t A = state->State[0];
+        uint32_t B = state->State[1];
+        uint32_t C = state->State[2];
+        uint32_t D = state->State[3];
 
         // Perform MD5 transformations
         // Round 1
@@ -318,203 +679,610 @@ static void MD5_UpdateHash(md5_context *context, uint8_t *ptr, uint64_t byteCoun
         C = MD5_TransformII(C, D, A, B, block[2], 15, 0x2ad7d2bb);
         B = MD5_TransformII(B, C, D, A, block[9], 21, 0xeb86d391);
 
-        context->State[0] += A;
-        context->State[1] += B;
-        context->State[2] += C;
-        context->State[3] += D;
+        state->State[0] += A;
+        state->State[1] += B;
+        state->State[2] += C;
+        state->State[3] += D;
     }
 
     // TODO (Aaron): I'm not sure this is necessary on modern machines, but maybe on embedded devices
     // Zero out block[] to prevent sensitive information being left in memory
-    MD5_MemorySet((uint8_t *)&block, 0, MD5_ArrayCount(block));
+    if (!state->DisableScrubbing)
+    {
+        MD5_SecureZero(block, sizeof(block));
+    }
 }
+#endif
 
 
-static void MD5_ConstructDigest(md5_context *context)
+// Note (Aaron): The 64 MD5 steps as (function, a, b, c, d, message word, shift, constant) so that
+// kernels working on other register types can expand them with their own step macro.
+#define MD5_STEPS(STEP) \
+    MD5_STEPS4_0(STEP) MD5_STEPS4_1(STEP) MD5_STEPS4_2(STEP) MD5_STEPS4_3(STEP) \
+    MD5_STEPS4_4(STEP) MD5_STEPS4_5(STEP) MD5_STEPS4_6(STEP) MD5_STEPS4_7(STEP) \
+    MD5_STEPS4_8(STEP) MD5_STEPS4_9(STEP) MD5_STEPS4_10(STEP) MD5_STEPS4_11(STEP) \
+    MD5_STEPS4_12(STEP) MD5_STEPS4_13(STEP) MD5_STEPS4_14(STEP) MD5_STEPS4_15(STEP)
+
+// Note (Aaron): Each group of four steps leaves the names of A-D in their original order so that
+// kernels can interleave the groups with other work.
+#define MD5_STEPS4_0(STEP) \
+    STEP(F, A, B, C, D, 0, 7, 0xd76aa478) \
+    STEP(F, D, A, B, C, 1, 12, 0xe8c7b756) \
+    STEP(F, C, D, A, B, 2, 17, 0x242070db) \
+    STEP(F, B, C, D, A, 3, 22, 0xc1bdceee)
+#define MD5_STEPS4_1(STEP) \
+    STEP(F, A, B, C, D, 4, 7, 0xf57c0faf) \
+    STEP(F, D, A, B, C, 5, 12, 0x4787c62a) \
+    STEP(F, C, D, A, B, 6, 17, 0xa8304613) \
+    STEP(F, B, C, D, A, 7, 22, 0xfd469501)
+#define MD5_STEPS4_2(STEP) \
+    STEP(F, A, B, C, D, 8, 7, 0x698098d8) \
+    STEP(F, D, A, B, C, 9, 12, 0x8b44f7af) \
+    STEP(F, C, D, A, B, 10, 17, 0xffff5bb1) \
+    STEP(F, B, C, D, A, 11, 22, 0x895cd7be)
+#define MD5_STEPS4_3(STEP) \
+    STEP(F, A, B, C, D, 12, 7, 0x6b901122) \
+    STEP(F, D, A, B, C, 13, 12, 0xfd987193) \
+    STEP(F, C, D, A, B, 14, 17, 0xa679438e) \
+    STEP(F, B, C, D, A, 15, 22, 0x49b40821)
+#define MD5_STEPS4_4(STEP) \
+    STEP(G, A, B, C, D, 1, 5, 0xf61e2562) \
+    STEP(G, D, A, B, C, 6, 9, 0xc040b340) \
+    STEP(G, C, D, A, B, 11, 14, 0x265e5a51) \
+    STEP(G, B, C, D, A, 0, 20, 0xe9b6c7aa)
+#define MD5_STEPS4_5(STEP) \
+    STEP(G, A, B, C, D, 5, 5, 0xd62f105d) \
+    STEP(G, D, A, B, C, 10, 9, 0x02441453) \
+    STEP(G, C, D, A, B, 15, 14, 0xd8a1e681) \
+    STEP(G, B, C, D, A, 4, 20, 0xe7d3fbc8)
+#define MD5_STEPS4_6(STEP) \
+    STEP(G, A, B, C, D, 9, 5, 0x21e1cde6) \
+    STEP(G, D, A, B, C, 14, 9, 0xc33707d6) \
+    STEP(G, C, D, A, B, 3, 14, 0xf4d50d87) \
+    STEP(G, B, C, D, A, 8, 20, 0x455a14ed)
+#define MD5_STEPS4_7(STEP) \
+    STEP(G, A, B, C, D, 13, 5, 0xa9e3e905) \
+    STEP(G, D, A, B, C, 2, 9, 0xfcefa3f8) \
+    STEP(G, C, D, A, B, 7, 14, 0x676f02d9) \
+    STEP(G, B, C, D, A, 12, 20, 0x8d2a4c8a)
+#define MD5_STEPS4_8(STEP) \
+    STEP(H, A, B, C, D, 5, 4, 0xfffa3942) \
+    STEP(H, D, A, B, C, 8, 11, 0x8771f681) \
+    STEP(H, C, D, A, B, 11, 16, 0x6d9d6122) \
+    STEP(H, B, C, D, A, 14, 23, 0xfde5380c)
+#define MD5_STEPS4_9(STEP) \
+    STEP(H, A, B, C, D, 1, 4, 0xa4beea44) \
+    STEP(H, D, A, B, C, 4, 11, 0x4bdecfa9) \
+    STEP(H, C, D, A, B, 7, 16, 0xf6bb4b60) \
+    STEP(H, B, C, D, A, 10, 23, 0xbebfbc70)
+#define MD5_STEPS4_10(STEP) \
+    STEP(H, A, B, C, D, 13, 4, 0x289b7ec6) \
+    STEP(H, D, A, B, C, 0, 11, 0xeaa127fa) \
+    STEP(H, C, D, A, B, 3, 16, 0xd4ef3085) \
+    STEP(H, B, C, D, A, 6, 23, 0x04881d05)
+#define MD5_STEPS4_11(STEP) \
+    STEP(H, A, B, C, D, 9, 4, 0xd9d4d039) \
+    STEP(H, D, A, B, C, 12, 11, 0xe6db99e5) \
+    STEP(H, C, D, A, B, 15, 16, 0x1fa27cf8) \
+    STEP(H, B, C, D, A, 2, 23, 0xc4ac5665)
+#define MD5_STEPS4_12(STEP) \
+    STEP(I, A, B, C, D, 0, 6, 0xf4292244) \
+    STEP(I, D, A, B, C, 7, 10, 0x432aff97) \
+    STEP(I, C, D, A, B, 14, 15, 0xab9423a7) \
+    STEP(I, B, C, D, A, 5, 21, 0xfc93a039)
+#define MD5_STEPS4_13(STEP) \
+    STEP(I, A, B, C, D, 12, 6, 0x655b59c3) \
+    STEP(I, D, A, B, C, 3, 10, 0x8f0ccc92) \
+    STEP(I, C, D, A, B, 10, 15, 0xffeff47d) \
+    STEP(I, B, C, D, A, 1, 21, 0x85845dd1)
+#define MD5_STEPS4_14(STEP) \
+    STEP(I, A, B, C, D, 8, 6, 0x6fa87e4f) \
+    STEP(I, D, A, B, C, 15, 10, 0xfe2ce6e0) \
+    STEP(I, C, D, A, B, 6, 15, 0xa3014314) \
+    STEP(I, B, C, D, A, 13, 21, 0x4e0811a1)
+#define MD5_STEPS4_15(STEP) \
+    STEP(I, A, B, C, D, 4, 6, 0xf7537e82) \
+    STEP(I, D, A, B, C, 11, 10, 0xbd3af235) \
+    STEP(I, C, D, A, B, 2, 15, 0x2ad7d2bb) \
+    STEP(I, B, C, D, A, 9, 21, 0xeb86d391)
+
+#define MD5_ROTL_CONSTANT(x, count) (((x) << (count)) | ((x) >> (32 - (count))))
+
+// Note (Aaron): The message word and constant are added first because they do not depend on the
+// previous step. 'b' is the value produced by the previous step, so each auxiliary function is
+// arranged to need it as late as possible: F uses the d ^ (b & (c ^ d)) form and G adds its two
+// terms separately (they never share set bits) so that c & ~d can be added before 'b' is ready.
+#define MD5_SCALAR_F(a, b, c, d) a += (d) ^ ((b) & ((c) ^ (d)))
+#define MD5_SCALAR_G(a, b, c, d) a += (c) & ~(d); a += (b) & (d)
+#define MD5_SCALAR_H(a, b, c, d) a += (b) ^ ((c) ^ (d))
+#define MD5_SCALAR_I(a, b, c, d) a += (c) ^ ((b) | ~(d))
+
+#define MD5_SCALAR_STEP(f, a, b, c, d, k, s, t) \
+    a += X[k] + (uint32_t)(t); \
+    MD5_SCALAR_##f(a, b, c, d); \
+    a = MD5_ROTL_CONSTANT(a, s) + b;
+
+
+#if !HASHUTIL_MD5_USE_TRANSFORM_FUNCTIONS || HASHUTIL_MD5_INCLUDE_ALL_KERNELS
+// Note (Aaron): Expands all 64 steps inline so that every rotate count and constant is an immediate.
+static void MD5_UpdateHashUnrolled(md5_hash *state, uint8_t *ptr, uint64_t byteCount)
 {
-    md5_static_assert(MD5_ArrayCount(context->DigestStr) == (128 / 4 + 1),
-                      "Buffer is not large enough to hold MD5 digest");
+    md5_assert(byteCount % MD5_MESSAGE_BLOCK_SIZE == 0);
+
+    uint32_t X[16];
+
+    uint32_t A = state->State[0];
+    uint32_t B = state->State[1];
+    uint32_t C = state->State[2];
+    uint32_t D = state->State[3];
 
-    // Extract digest values, convert to string, and store in context
-    unsigned int i, j;
-    for (i = 0, j = 0; i < 4; ++i, j+=4)
+    // Iterate over blocks of the message
+    // 'i' holds the current block's byte position in the message
+    for (uint64_t i = 0; i < byteCount; i += MD5_MESSAGE_BLOCK_SIZE)
     {
-        context->Digest[j] = (uint8_t)(context->State[i] & 0xff);
-        context->Digest[j+1] = (uint8_t)((context->State[i] >> 8) & 0xff);
-        context->Digest[j+2] = (uint8_t)((context->State[i] >> 16) & 0xff);
-        context->Digest[j+3] = (uint8_t)((context->State[i] >> 24) & 0xff);
+        for (size_t j = 0; j < MD5_ArrayCount(X); ++j)
+        {
+            X[j] = MD5_LoadLE32(ptr + i + (j * 4));
+        }
 
-        sprintf(context->DigestStr + (j*2),
-                "%02x%02x%02x%02x",
-                context->Digest[j],
-                context->Digest[j+1],
-                context->Digest[j+2],
-                context->Digest[i*4+3]);
+        MD5_STEPS(MD5_SCALAR_STEP)
+
+        A = (state->State[0] += A);
+        B = (state->State[1] += B);
+        C = (state->State[2] += C);
+        D = (state->State[3] += D);
+    }
+
+    // Zero out X[] to prevent sensitive information being left in memory
+    if (!state->DisableScrubbing)
+    {
+        MD5_SecureZero(X, sizeof(X));
     }
 }
+#endif
 
 
-md5_context MD5_HashString(char *messagePtr)
+typedef void md5_kernel(md5_hash *state, uint8_t *ptr, uint64_t byteCount);
+
+typedef struct
 {
-    md5_context context;
-    MD5_InitializeContext(&context);
+    char const *Name;
+    uint32_t RequiredFeatures;
+    md5_kernel *Kernel;
+} md5_kernel_info;
+
+// Note (Aaron): Kernels in order of preference. The first kernel the CPU supports is used unless
+// HASHUTIL_FORCE_KERNEL names another supported kernel.
+static md5_kernel_info const MD5_Kernels[] =
+{
+#if HASHUTIL_MD5_USE_TRANSFORM_FUNCTIONS
+    { "scalar", 0, MD5_UpdateHashTransforms },
+#else
+    { "scalar", 0, MD5_UpdateHashUnrolled },
+#endif
+};
+
 
-    uint8_t messageBlockByteCount = 0;
-    md5_static_assert(UINT8_MAX > (MD5_MESSAGE_BLOCK_SIZE * 2),
-                      "messageBlockByteCount cannot fit within a uint8_t");
+// Returns the kernel name set in the HASHUTIL_FORCE_KERNEL environment variable, or 0 if it is not set
+static char const *MD5_GetForcedKernelName()
+{
+#if MD5_USE_IFUNC
+    // Note (Aaron): The ifunc resolvers run before libc has set up the environment, so kernels
+    // cannot be forced in HASHUTIL_USE_IFUNC builds. Ignoring the variable everywhere keeps the
+    // batch kernels and MD5_GetKernelName() consistent with the bound kernel.
+    return 0;
+#else
+    // Note (Aaron): 0 until the variable has been read. Afterwards the cache holds its value, or
+    // 'noForcedName' when it is not set.
+    static char const noForcedName[] = "";
+    static void const *forcedName = 0;
 
-    // Iterate over message until we can no longer fill a message block
-    while (*messagePtr != 0x00)
+    char const *name = (char const *)MD5_AtomicLoadPointer(&forcedName);
+    if (!name)
     {
-        md5_assert(messageBlockByteCount < MD5_MESSAGE_BLOCK_SIZE);
+        char const *value = getenv("HASHUTIL_FORCE_KERNEL");
+        name = (value && value[0]) ? value : noForcedName;
+        MD5_AtomicStorePointer(&forcedName, name);
+    }
 
-        messagePtr++;
-        messageBlockByteCount++;
-        context.MessageLengthBits += 8;
+    return (name == noForcedName) ? 0 : name;
+#endif
+}
 
-        // Process the message in blocks of 512 bits (64 bytes or sixteen 32-bit words)
-        if(messageBlockByteCount == MD5_MESSAGE_BLOCK_SIZE)
-        {
-            MD5_UpdateHash(&context, (uint8_t *)(messagePtr - messageBlockByteCount), messageBlockByteCount);
-            messageBlockByteCount = 0;
-        }
-    }
 
-    // Allocate memory to store the message remainder + padding + encoded message length
-    // Note (Aaron): We use a double sized buffer to cover the worst case scenario
-    // where the message remainder + padding + message length cannot fit into one
-    // message block.
-    uint8_t buffer[MD5_MESSAGE_BLOCK_SIZE * 2];
-    uint8_t *bufferPtr = buffer;
-    uint8_t bufferSizeBytes = MD5_MESSAGE_BLOCK_SIZE * 2;
-    md5_static_assert(UINT8_MAX > (MD5_MESSAGE_BLOCK_SIZE * 2),
-                      "bufferSizeBytes cannot fit within a uint8_t");
+// Returns true unless HASHUTIL_FORCE_KERNEL names a different kernel than 'name'
+static bool MD5_IsKernelAllowed(char const *name)
+{
+    char const *forcedName = MD5_GetForcedKernelName();
+    return !forcedName || (strcmp(forcedName, name) == 0);
+}
 
-#if HASHUTIL_SLOW
-    // Note (Aaron): Packing the buffer's bits with 1s for debug purposes
-    MD5_MemorySet(bufferPtr, 0xff, sizeof(buffer));
+
+static bool MD5_IsKernelSupported(uint32_t requiredFeatures)
+{
+#if MD5_X64
+    return MD5_HasCPUFeatures(requiredFeatures);
+#else
+    return requiredFeatures == 0;
 #endif
+}
 
-    md5_assert(messageBlockByteCount <= (bufferSizeBytes - MD5_MESSAGE_LENGTH_BLOCK_SHA256 - 1));
 
-    // Copy message remainder (if any) into the buffer
-    if (messageBlockByteCount > 0)
+// Picks the kernel named 'forcedName' if the CPU supports it, otherwise the preferred kernel
+static md5_kernel_info const *MD5_SelectKernel(char const *forcedName)
+{
+    if (forcedName)
+    {
+        for (size_t i = 0; i < MD5_ArrayCount(MD5_Kernels); ++i)
+        {
+            if ((strcmp(MD5_Kernels[i].Name, forcedName) == 0) && MD5_IsKernelSupported(MD5_Kernels[i].RequiredFeatures))
+            {
+                return &MD5_Kernels[i];
+            }
+        }
+    }
+
+    for (size_t i = 0; i < MD5_ArrayCount(MD5_Kernels); ++i)
     {
-        MD5_MemoryCopy(bufferPtr, (uint8_t *)(messagePtr - messageBlockByteCount), messageBlockByteCount);
+        if (MD5_IsKernelSupported(MD5_Kernels[i].RequiredFeatures))
+        {
+            return &MD5_Kernels[i];
+        }
     }
 
-    // Apply padded 1
-    uint8_t *paddingPtr = bufferPtr + messageBlockByteCount;
-    *paddingPtr++ = (1 << 7);
+    md5_assert(false);
+    return &MD5_Kernels[MD5_ArrayCount(MD5_Kernels) - 1];
+}
 
-    bool useFullBuffer = (messageBlockByteCount >= (MD5_MESSAGE_BLOCK_SIZE - MD5_MESSAGE_LENGTH_BLOCK_SHA256 - 1));
 
-    // Apply padded 0s
-    uint8_t *paddingEndPtr = useFullBuffer
-        ? bufferPtr + bufferSizeBytes - MD5_MESSAGE_LENGTH_BLOCK_SHA256
-        : bufferPtr + MD5_MESSAGE_BLOCK_SIZE - MD5_MESSAGE_LENGTH_BLOCK_SHA256;
+static md5_kernel_info const *MD5_GetKernelInfo()
+{
+    // Note (Aaron): The kernel is only selected once. Racing threads select the same kernel, and
+    // the cache is a single pointer that is loaded and stored atomically.
+    static void const *selectedKernel = 0;
 
-    while (paddingPtr < paddingEndPtr)
+    md5_kernel_info const *kernel = (md5_kernel_info const *)MD5_AtomicLoadPointer(&selectedKernel);
+    if (!kernel)
     {
-        *paddingPtr++ = 0;
+        kernel = MD5_SelectKernel(MD5_GetForcedKernelName());
+        MD5_AtomicStorePointer(&selectedKernel, kernel);
     }
 
-    // Append the length of the message as a 64-bit representation
-    uint64_t *sizePtr = (uint64_t *)paddingPtr;
-    *sizePtr = (uint64_t)context.MessageLengthBits;
+    return kernel;
+}
 
-    // Apply final hash update and construct the digest
-    messageBlockByteCount = useFullBuffer ? bufferSizeBytes : MD5_MESSAGE_BLOCK_SIZE;
-    md5_assert(messageBlockByteCount == (paddingPtr - bufferPtr) + sizeof(uint64_t));
-    MD5_UpdateHash(&context, bufferPtr, messageBlockByteCount);
-    MD5_ConstructDigest(&context);
 
-    // Zero out message remainder to prevent sensitive information being left in memory
-    MD5_MemorySet(bufferPtr, 0, messageBlockByteCount);
+#if MD5_USE_IFUNC
+// Note (Aaron): Resolver for the MD5_UpdateHash() indirect function. It runs while the dynamic loader
+// relocates the module, before constructors, so it may only rely on CPUID and libc.
+static md5_kernel *MD5_ResolveUpdateHash()
+{
+    return MD5_GetKernelInfo()->Kernel;
+}
 
-    return context;
+static void MD5_UpdateHash(md5_hash *state, uint8_t *ptr, uint64_t byteCount) __attribute__((ifunc("MD5_ResolveUpdateHash")));
+#else
+static void MD5_UpdateHash(md5_hash *state, uint8_t *ptr, uint64_t byteCount)
+{
+    MD5_GetKernelInfo()->Kernel(state, ptr, byteCount);
 }
+#endif
 
 
-md5_context MD5_HashFile(const char *fileName)
+char const *MD5_GetKernelName()
 {
-    md5_context result;
-    MD5_InitializeContext(&result);
+    return MD5_GetKernelInfo()->Name;
+}
 
-    FILE *file = fopen(fileName, "rb");
-    if(!file)
-    {
-        md5_assert(false);
+// Note (Aaron): Multi-buffer kernels hash independent messages side by side with one message
+// per 32-bit vector lane. The state is stored transposed so that each state word of every
+// lane can be loaded into a single vector register.
+#define MD5_MULTI_BUFFER_MAX_LANES 16
 
-        result.Error = true;
-        sprintf(result.ErrorStr, "Unable to open file");
-        sprintf(result.DigestStr, "");
-        return result;
-    }
+typedef struct
+{
+    uint32_t State[4][MD5_MULTI_BUFFER_MAX_LANES];
+    uint8_t const *BlockPtrs[MD5_MULTI_BUFFER_MAX_LANES];
+    bool DisableScrubbing;
+} md5_multi_buffer_state;
 
-    // Note (Aaron): Create a buffer that can hold two full message blocks as
-    // we will potentially use the extra space when applying padding later.
-    uint8_t buffer[MD5_MESSAGE_BLOCK_SIZE * 2];
-    uint8_t *bufferPtr = buffer;
-    uint8_t bufferSizeBytes = MD5_MESSAGE_BLOCK_SIZE * 2;
-    md5_static_assert(UINT8_MAX > (MD5_MESSAGE_BLOCK_SIZE * 2),
-                      "bufferSizeBytes cannot fit within a uint8_t");
+// Hashes 'blockCount' message blocks for every lane set in 'laneMask'. Lanes not set in the mask
+// must point at a readable message block and keep their state and block pointer unchanged.
+typedef void md5_multi_buffer_kernel(md5_multi_buffer_state *state, uint32_t laneMask, uint64_t blockCount);
 
-#if HASHUTIL_SLOW
-    // Note (Aaron): Packing the buffer's bits with 1s for debug purposes
-    MD5_MemorySet((uint8_t *)buffer, 0xff, sizeof(buffer));
-#endif
+// Note (Aaron): Idle lanes read from this block so that the kernels never need to branch per lane
+static uint8_t const MD5_IdleMessageBlock[MD5_MESSAGE_BLOCK_SIZE] = {0};
 
-    size_t readElementSize = sizeof(uint8_t);
-    size_t readBlockSize = sizeof(uint8_t) * MD5_MESSAGE_BLOCK_SIZE;
-    uint64_t blockBytesRead = 0;
 
-    // Note (Aaron): Sanity check
-    md5_assert(readElementSize == 1);
+#if MD5_X64
+#define MD5_AVX2_F(x, y, z) _mm256_xor_si256((z), _mm256_and_si256((x), _mm256_xor_si256((y), (z))))
+#define MD5_AVX2_G(x, y, z) _mm256_xor_si256((y), _mm256_and_si256((z), _mm256_xor_si256((x), (y))))
+#define MD5_AVX2_H(x, y, z) _mm256_xor_si256(_mm256_xor_si256((x), (y)), (z))
+#define MD5_AVX2_I(x, y, z) _mm256_xor_si256((y), _mm256_or_si256((x), _mm256_xor_si256((z), allOnes)))
 
-    // Update hash using file contents until we run out of chunks of sufficient size
-    blockBytesRead = fread(buffer, readElementSize, readBlockSize, file);
-    while(blockBytesRead)
-    {
-        md5_assert(blockBytesRead <= MD5_MESSAGE_BLOCK_SIZE);
-        result.MessageLengthBits += ((uint32_t)blockBytesRead * 8);
+#define MD5_AVX2_ROTL(x, count) \
+    _mm256_or_si256(_mm256_slli_epi32((x), (count)), _mm256_srli_epi32((x), 32 - (count)))
 
-        // Process the message in blocks of 512 bits (64 bytes or sixteen 32-bit words)
-        if (blockBytesRead == MD5_MESSAGE_BLOCK_SIZE)
-        {
-            MD5_UpdateHash(&result, bufferPtr, blockBytesRead);
-            blockBytesRead = fread(buffer, readElementSize, readBlockSize, file);
-            continue;
-        }
+#define MD5_AVX2_STEP(f, a, b, c, d, k, s, t) \
+    a = _mm256_add_epi32(b, MD5_AVX2_ROTL(_mm256_add_epi32(_mm256_add_epi32(a, MD5_AVX2_##f(b, c, d)), \
+                                                           _mm256_add_epi32(X[k], _mm256_set1_epi32((int)(t)))), s));
 
-        // Note (Aaron): If we ever read less bytes than MD5_MESSAGE_BLOCK_SIZE, it is time to stop
-        // reading the file.
-        break;
-    }
 
-    if(ferror(file))
-    {
-        fclose(file);
-        md5_assert(false);
+// Transposes an 8x8 matrix of 32-bit words so that row 'i' holds word 'i' of every input row
+MD5_TARGET("avx2")
+static void MD5_Transpose8x8AVX2(__m256i *rows)
+{
+    __m256i t0 = _mm256_unpacklo_epi32(rows[0], rows[1]);
+    __m256i t1 = _mm256_unpackhi_epi32(rows[0], rows[1]);
+    __m256i t2 = _mm256_unpacklo_epi32(rows[2], rows[3]);
+    __m256i t3 = _mm256_unpackhi_epi32(rows[2], rows[3]);
+    __m256i t4 = _mm256_unpacklo_epi32(rows[4], rows[5]);
+    __m256i t5 = _mm256_unpackhi_epi32(rows[4], rows[5]);
+    __m256i t6 = _mm256_unpacklo_epi32(rows[6], rows[7]);
+    __m256i t7 = _mm256_unpackhi_epi32(rows[6], rows[7]);
+
+    __m256i u0 = _mm256_unpacklo_epi64(t0, t2);
+    __m256i u1 = _mm256_unpackhi_epi64(t0, t2);
+    __m256i u2 = _mm256_unpacklo_epi64(t1, t3);
+    __m256i u3 = _mm256_unpackhi_epi64(t1, t3);
+    __m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+    __m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+    __m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+    __m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+
+    rows[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+    rows[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+    rows[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+    rows[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+    rows[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+    rows[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+    rows[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+    rows[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+}
 
-        result.Error = true;
-        sprintf(result.ErrorStr, "Error reading file");
-        sprintf(result.DigestStr, "");
-        return result;
-    }
 
-    fclose(file);
+MD5_TARGET("avx2")
+static void MD5_UpdateHashx8AVX2(md5_multi_buffer_state *state, uint32_t laneMask, uint64_t blockCount)
+{
+    md5_assert(laneMask != 0);
+    md5_assert(laneMask < (1 << 8));
 
-    // Apply padded 1
-    uint8_t *paddingPtr = bufferPtr + blockBytesRead;
-    *paddingPtr++ = (1 << 7);
+    __m256i const allOnes = _mm256_set1_epi32(-1);
 
-    bool useFullBuffer = (blockBytesRead >= (MD5_MESSAGE_BLOCK_SIZE - MD5_MESSAGE_LENGTH_BLOCK_SHA256 - 1));
+    // Expand the lane mask into a vector mask used to discard results for idle lanes
+    __m256i const laneBits = _mm256_setr_epi32(1 << 0, 1 << 1, 1 << 2, 1 << 3, 1 << 4, 1 << 5, 1 << 6, 1 << 7);
+    __m256i const activeLanes = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32((int)laneMask), laneBits), laneBits);
+
+    uint8_t const *blockPtrs[8];
+    uint64_t blockStrides[8];
+    for (int lane = 0; lane < 8; ++lane)
+    {
+        blockPtrs[lane] = state->BlockPtrs[lane];
+        blockStrides[lane] = (laneMask & (1 << lane)) ? MD5_MESSAGE_BLOCK_SIZE : 0;
+    }
+
+    __m256i initialState[4];
+    __m256i S[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        initialState[i] = _mm256_loadu_si256((__m256i const *)state->State[i]);
+        S[i] = initialState[i];
+    }
+
+    __m256i X[16];
+
+    for (uint64_t block = 0; block < blockCount; ++block)
+    {
+        // Note (Aaron): MD5 reads the message as little endian words so a transpose is all
+        // that is needed to gather X[0..15] for every lane.
+        for (int lane = 0; lane < 8; ++lane)
+        {
+            X[lane] = _mm256_loadu_si256((__m256i const *)(blockPtrs[lane] + 0));
+            X[lane + 8] = _mm256_loadu_si256((__m256i const *)(blockPtrs[lane] + 32));
+            blockPtrs[lane] += blockStrides[lane];
+        }
+
+        MD5_Transpose8x8AVX2(X + 0);
+        MD5_Transpose8x8AVX2(X + 8);
+
+        __m256i A = S[0];
+        __m256i B = S[1];
+        __m256i C = S[2];
+        __m256i D = S[3];
+
+        MD5_STEPS(MD5_AVX2_STEP)
+
+        S[0] = _mm256_add_epi32(S[0], A);
+        S[1] = _mm256_add_epi32(S[1], B);
+        S[2] = _mm256_add_epi32(S[2], C);
+        S[3] = _mm256_add_epi32(S[3], D);
+    }
+
+    for (int i = 0; i < 4; ++i)
+    {
+        _mm256_storeu_si256((__m256i *)state->State[i], _mm256_blendv_epi8(initialState[i], S[i], activeLanes));
+    }
+
+    for (int lane = 0; lane < 8; ++lane)
+    {
+        state->BlockPtrs[lane] = blockPtrs[lane];
+    }
+
+    // Zero out X[] to prevent sensitive information being left in memory
+    if (!state->DisableScrubbing)
+    {
+        MD5_SecureZero(X, sizeof(X));
+    }
+}
+
+
+// Note (Aaron): vpternlogd evaluates each auxiliary function in one instruction. The immediates
+// are the truth tables of F (0xca), G (0xe4), H (0x96) and I (0x39).
+#define MD5_AVX512_F(x, y, z) _mm512_ternarylogic_epi32((x), (y), (z), 0xca)
+#define MD5_AVX512_G(x, y, z) _mm512_ternarylogic_epi32((x), (y), (z), 0xe4)
+#define MD5_AVX512_H(x, y, z) _mm512_ternarylogic_epi32((x), (y), (z), 0x96)
+#define MD5_AVX512_I(x, y, z) _mm512_ternarylogic_epi32((x), (y), (z), 0x39)
+
+#define MD5_AVX512_STEP(f, a, b, c, d, k, s, t) \
+    a = _mm512_add_epi32(b, _mm512_rol_epi32(_mm512_add_epi32(_mm512_add_epi32(a, MD5_AVX512_##f(b, c, d)), \
+                                                              _mm512_add_epi32(X[k], _mm512_set1_epi32((int)(t)))), s));
+
+
+// Transposes a 16x16 matrix of 32-bit words so that row 'i' holds word 'i' of every input row
+MD5_TARGET("avx512f")
+static void MD5_Transpose16x16AVX512(__m512i *rows)
+{
+    __m512i t[16];
+    __m512i u[16];
+
+    for (int i = 0; i < 16; i += 2)
+    {
+        t[i + 0] = _mm512_unpacklo_epi32(rows[i], rows[i + 1]);
+        t[i + 1] = _mm512_unpackhi_epi32(rows[i], rows[i + 1]);
+    }
+
+    // Each 128-bit chunk 'j' of u[4 * g + k] now holds word 4 * j + k of rows 4 * g to 4 * g + 3
+    for (int i = 0; i < 16; i += 4)
+    {
+        u[i + 0] = _mm512_unpacklo_epi64(t[i + 0], t[i + 2]);
+        u[i + 1] = _mm512_unpackhi_epi64(t[i + 0], t[i + 2]);
+        u[i + 2] = _mm512_unpacklo_epi64(t[i + 1], t[i + 3]);
+        u[i + 3] = _mm512_unpackhi_epi64(t[i + 1], t[i + 3]);
+    }
+
+    for (int k = 0; k < 4; ++k)
+    {
+        __m512i low01 = _mm512_shuffle_i32x4(u[k + 0], u[k + 4], 0x44);
+        __m512i high01 = _mm512_shuffle_i32x4(u[k + 0], u[k + 4], 0xee);
+        __m512i low23 = _mm512_shuffle_i32x4(u[k + 8], u[k + 12], 0x44);
+        __m512i high23 = _mm512_shuffle_i32x4(u[k + 8], u[k + 12], 0xee);
+
+        rows[k + 0] = _mm512_shuffle_i32x4(low01, low23, 0x88);
+        rows[k + 4] = _mm512_shuffle_i32x4(low01, low23, 0xdd);
+        rows[k + 8] = _mm512_shuffle_i32x4(high01, high23, 0x88);
+        rows[k + 12] = _mm512_shuffle_i32x4(high01, high23, 0xdd);
+    }
+}
+
+
+MD5_TARGET("avx512f")
+static void MD5_UpdateHashx16AVX512(md5_multi_buffer_state *state, uint32_t laneMask, uint64_t blockCount)
+{
+    md5_assert(laneMask != 0);
+    md5_assert(laneMask < (1 << 16));
+
+    __mmask16 const activeLanes = (__mmask16)laneMask;
+
+    uint8_t const *blockPtrs[16];
+    uint64_t blockStrides[16];
+    for (int lane = 0; lane < 16; ++lane)
+    {
+        blockPtrs[lane] = state->BlockPtrs[lane];
+        blockStrides[lane] = (laneMask & (1 << lane)) ? MD5_MESSAGE_BLOCK_SIZE : 0;
+    }
+
+    __m512i S[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        S[i] = _mm512_loadu_si512(state->State[i]);
+    }
+
+    __m512i X[16];
+
+    for (uint64_t block = 0; block < blockCount; ++block)
+    {
+        // Each lane's message block fills one register, transposing gives X[0..15] for every lane
+        for (int lane = 0; lane < 16; ++lane)
+        {
+            X[lane] = _mm512_loadu_si512(blockPtrs[lane]);
+            blockPtrs[lane] += blockStrides[lane];
+        }
+
+        MD5_Transpose16x16AVX512(X);
+
+        __m512i A = S[0];
+        __m512i B = S[1];
+        __m512i C = S[2];
+        __m512i D = S[3];
+
+        MD5_STEPS(MD5_AVX512_STEP)
+
+        S[0] = _mm512_add_epi32(S[0], A);
+        S[1] = _mm512_add_epi32(S[1], B);
+        S[2] = _mm512_add_epi32(S[2], C);
+        S[3] = _mm512_add_epi32(S[3], D);
+    }
+
+    // Only active lanes are written back, idle lanes keep their state
+    for (int i = 0; i < 4; ++i)
+    {
+        _mm512_mask_storeu_epi32(state->State[i], activeLanes, S[i]);
+    }
+
+    for (int lane = 0; lane < 16; ++lane)
+    {
+        state->BlockPtrs[lane] = blockPtrs[lane];
+    }
+
+    // Zero out X[] to prevent sensitive information being left in memory
+    if (!state->DisableScrubbing)
+    {
+        MD5_SecureZero(X, sizeof(X));
+    }
+}
+#endif
+
+
+// Writes the digest bytes and, if digestStr is not null, the digest as a lowercase hex string
+static void MD5_WriteDigest(md5_hash const *state, uint8_t *digestPtr, char *digestStr)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        digestPtr[i*4] = (uint8_t)(state->State[i] & 0xff);
+        digestPtr[i*4+1] = (uint8_t)((state->State[i] >> 8) & 0xff);
+        digestPtr[i*4+2] = (uint8_t)((state->State[i] >> 16) & 0xff);
+        digestPtr[i*4+3] = (uint8_t)((state->State[i] >> 24) & 0xff);
+    }
+
+    if (digestStr)
+    {
+        // Note (Aaron): A nibble lookup is much cheaper than sprintf() when hashing many small messages
+        static char const hexDigits[] = "0123456789abcdef";
+        for (int i = 0; i < MD5_DIGEST_SIZE; ++i)
+        {
+            digestStr[i*2] = hexDigits[digestPtr[i] >> 4];
+            digestStr[i*2+1] = hexDigits[digestPtr[i] & 0x0f];
+        }
+        digestStr[MD5_DIGEST_SIZE * 2] = '\0';
+    }
+}
 
-    // Apply padded 0s
-    uint8_t *paddingEndPtr = useFullBuffer
-        ? bufferPtr + bufferSizeBytes - MD5_MESSAGE_LENGTH_BLOCK_SHA256
-        : bufferPtr + MD5_MESSAGE_BLOCK_SIZE - MD5_MESSAGE_LENGTH_BLOCK_SHA256;
+
+static void MD5_ConstructDigest(md5_context *context)
+{
+    md5_static_assert(MD5_ArrayCount(context->DigestStr) == (128 / 4 + 1),
+                      "Buffer is not large enough to hold MD5 digest");
+
+    MD5_WriteDigest(&context->Hash, context->Digest, context->DigestStr);
+}
+
+
+// Pads the message remainder at the start of a buffer that can hold two message blocks and
+// returns the number of bytes to hash from the buffer.
+static uint32_t MD5_ApplyPadding(uint8_t *bufferPtr, uint32_t remainderByteCount, uint64_t messageLengthBits)
+{
+    md5_assert(remainderByteCount < MD5_MESSAGE_BLOCK_SIZE);
+
+    // Apply padded 1
+    uint8_t *paddingPtr = bufferPtr + remainderByteCount;
+    *paddingPtr++ = (1 << 7);
+
+    bool useFullBuffer = (remainderByteCount > (MD5_MESSAGE_BLOCK_SIZE - MD5_MESSAGE_LENGTH_BLOCK_SHA256 - 1));
+
+    // Apply padded 0s
+    uint8_t *paddingEndPtr = useFullBuffer
+        ? bufferPtr + (MD5_MESSAGE_BLOCK_SIZE * 2) - MD5_MESSAGE_LENGTH_BLOCK_SHA256
+        : bufferPtr + MD5_MESSAGE_BLOCK_SIZE - MD5_MESSAGE_LENGTH_BLOCK_SHA256;
 
     while (paddingPtr < paddingEndPtr)
     {
@@ -522,19 +1290,462 @@ md5_context MD5_HashFile(const char *fileName)
     }
 
     // Append the length of the message as a 64-bit representation
-    uint64_t *sizePtr = (uint64_t *)paddingPtr;
-    *sizePtr = (uint64_t)result.MessageLengthBits;
+    MD5_StoreLE64(paddingPtr, messageLengthBits);
+
+    uint32_t finalByteCount = useFullBuffer ? (MD5_MESSAGE_BLOCK_SIZE * 2) : MD5_MESSAGE_BLOCK_SIZE;
+    md5_assert(finalByteCount == (paddingPtr - bufferPtr) + sizeof(uint64_t));
+
+    return finalByteCount;
+}
+
+
+static void MD5_UpdateHashState(md5_hash *state, void const *messagePtr, size_t byteCount)
+{
+    if (byteCount == 0)
+    {
+        return;
+    }
+
+    uint8_t *bytePtr = (uint8_t *)messagePtr;
+
+    // Note (Aaron): MD5 only uses the low-order 64 bits of the message length so
+    // we allow the length to wrap around here.
+    state->MessageLengthBits += ((uint64_t)byteCount * 8);
+
+    // Top up a partially filled message block before touching the new data
+    if (state->MessageBlockByteCount > 0)
+    {
+        md5_assert(state->MessageBlockByteCount < MD5_MESSAGE_BLOCK_SIZE);
+
+        size_t fillByteCount = MD5_MESSAGE_BLOCK_SIZE - state->MessageBlockByteCount;
+        if (fillByteCount > byteCount)
+        {
+            fillByteCount = byteCount;
+        }
+
+        MD5_MemoryCopy(state->MessageBlock + state->MessageBlockByteCount, bytePtr, fillByteCount);
+        state->MessageBlockByteCount += (uint32_t)fillByteCount;
+        bytePtr += fillByteCount;
+        byteCount -= fillByteCount;
+
+        if (state->MessageBlockByteCount < MD5_MESSAGE_BLOCK_SIZE)
+        {
+            return;
+        }
+
+        MD5_UpdateHash(state, state->MessageBlock, MD5_MESSAGE_BLOCK_SIZE);
+        state->MessageBlockByteCount = 0;
+    }
+
+    // Process all whole message blocks directly from the caller's memory
+    size_t wholeBlockByteCount = byteCount - (byteCount % MD5_MESSAGE_BLOCK_SIZE);
+    if (wholeBlockByteCount > 0)
+    {
+        MD5_UpdateHash(state, bytePtr, wholeBlockByteCount);
+        bytePtr += wholeBlockByteCount;
+        byteCount -= wholeBlockByteCount;
+    }
+
+    // Hold on to the message remainder until more data arrives or the hash is finalized
+    if (byteCount > 0)
+    {
+        MD5_MemoryCopy(state->MessageBlock, bytePtr, byteCount);
+        state->MessageBlockByteCount = (uint32_t)byteCount;
+    }
+}
+
+
+static void MD5_FinalizeHashState(md5_hash *state, uint8_t *digestPtr, char *digestStr)
+{
+    // Note (Aaron): We use a double sized buffer to cover the worst case scenario
+    // where the message remainder + padding + message length cannot fit into one
+    // message block.
+    uint8_t buffer[MD5_MESSAGE_BLOCK_SIZE * 2];
+    uint8_t *bufferPtr = buffer;
+    uint32_t remainderByteCount = state->MessageBlockByteCount;
+
+#if HASHUTIL_SLOW
+    // Note (Aaron): Packing the buffer's bits with 1s for debug purposes
+    MD5_MemorySet(bufferPtr, 0xff, sizeof(buffer));
+#endif
+
+    md5_assert(remainderByteCount < MD5_MESSAGE_BLOCK_SIZE);
+
+    // Copy message remainder (if any) into the buffer
+    if (remainderByteCount > 0)
+    {
+        MD5_MemoryCopy(bufferPtr, state->MessageBlock, remainderByteCount);
+    }
+
+    // Apply padding and the message length, then the final hash update and construct the digest
+    uint32_t finalByteCount = MD5_ApplyPadding(bufferPtr, remainderByteCount, state->MessageLengthBits);
+    MD5_UpdateHash(state, bufferPtr, finalByteCount);
+    MD5_WriteDigest(state, digestPtr, digestStr);
+
+    // Zero out message remainder to prevent sensitive information being left in memory
+    if (!state->DisableScrubbing)
+    {
+        MD5_SecureZero(bufferPtr, finalByteCount);
+        MD5_SecureZero(state->MessageBlock, sizeof(state->MessageBlock));
+    }
+    state->MessageBlockByteCount = 0;
+}
+
+
+void MD5_InitState(md5_state *state)
+{
+    MD5_InitializeState(&state->Hash);
+}
+
+
+void MD5_UpdateState(md5_state *state, void const *messagePtr, size_t byteCount)
+{
+    MD5_UpdateHashState(&state->Hash, messagePtr, byteCount);
+}
+
+
+void MD5_FinalState(md5_state *state, uint8_t *digestPtr, char *digestStr)
+{
+    MD5_FinalizeHashState(&state->Hash, digestPtr, digestStr);
+}
+
 
-    // Perform final hash update
-    blockBytesRead = useFullBuffer ? bufferSizeBytes : MD5_MESSAGE_BLOCK_SIZE;
-    md5_assert(blockBytesRead == (paddingPtr - bufferPtr) + sizeof(uint64_t));
-    MD5_UpdateHash(&result, bufferPtr, blockBytesRead);
+void MD5_DigestBuffer(void const *messagePtr, size_t byteCount, uint8_t *digestPtr, char *digestStr)
+{
+    md5_state state;
+    MD5_InitializeState(&state.Hash);
+
+    MD5_UpdateHashState(&state.Hash, messagePtr, byteCount);
+    MD5_FinalizeHashState(&state.Hash, digestPtr, digestStr);
+}
+
+
+void MD5_ExportState(md5_hash const *state, uint8_t *bufferPtr)
+{
+    md5_assert(state->MessageBlockByteCount < MD5_MESSAGE_BLOCK_SIZE);
+
+    MD5_MemoryCopy(bufferPtr, "MD5", 4);
+    MD5_StoreLE32(bufferPtr + 4, MD5_STATE_FORMAT_VERSION);
+    MD5_StoreLE32(bufferPtr + 8, MD5_DIGEST_SIZE * 8);
+
+    for (int i = 0; i < 4; ++i)
+    {
+        MD5_StoreLE32(bufferPtr + 12 + (i * 4), state->State[i]);
+    }
+
+    MD5_StoreLE64(bufferPtr + 28, state->MessageLengthBits);
+    MD5_StoreLE32(bufferPtr + 36, state->MessageBlockByteCount);
+
+    // Note (Aaron): Only the buffered bytes are copied so stale block contents never leave the state
+    uint8_t *blockPtr = bufferPtr + 40;
+    MD5_MemorySet(blockPtr, 0, MD5_MESSAGE_BLOCK_SIZE);
+    if (state->MessageBlockByteCount > 0)
+    {
+        MD5_MemoryCopy(blockPtr, state->MessageBlock, state->MessageBlockByteCount);
+    }
+}
+
+
+md5_result MD5_ImportState(md5_hash *state, uint8_t const *bufferPtr)
+{
+    uint64_t messageLengthBits = MD5_LoadLE64(bufferPtr + 28);
+    uint32_t messageBlockByteCount = MD5_LoadLE32(bufferPtr + 36);
+
+    // Note (Aaron): Whole bytes are hashed, and the buffered bytes are always the message tail
+    // that does not fill a block. MD5 keeps the length modulo 2^64, which preserves the tail size.
+    if (memcmp(bufferPtr, "MD5", 4) != 0
+        || MD5_LoadLE32(bufferPtr + 4) != MD5_STATE_FORMAT_VERSION
+        || MD5_LoadLE32(bufferPtr + 8) != MD5_DIGEST_SIZE * 8
+        || (messageLengthBits % 8) != 0
+        || messageBlockByteCount != (messageLengthBits / 8) % MD5_MESSAGE_BLOCK_SIZE)
+    {
+        return MD5_RESULT_INVALID_STATE;
+    }
+
+    MD5_InitializeState(state);
+
+    for (int i = 0; i < 4; ++i)
+    {
+        state->State[i] = MD5_LoadLE32(bufferPtr + 12 + (i * 4));
+    }
+
+    state->MessageLengthBits = messageLengthBits;
+    state->MessageBlockByteCount = messageBlockByteCount;
+    if (messageBlockByteCount > 0)
+    {
+        MD5_MemoryCopy(state->MessageBlock, bufferPtr + 40, messageBlockByteCount);
+    }
+
+    return MD5_RESULT_OK;
+}
+
+
+void MD5_Init(md5_context *context)
+{
+    MD5_InitializeContext(context);
+}
+
+
+void MD5_Update(md5_context *context, void const *messagePtr, size_t byteCount)
+{
+    if (context->Error)
+    {
+        return;
+    }
+
+    MD5_UpdateHashState(&context->Hash, messagePtr, byteCount);
+}
+
+
+void MD5_Final(md5_context *context)
+{
+    if (context->Error)
+    {
+        return;
+    }
+
+    MD5_FinalizeHashState(&context->Hash, context->Digest, context->DigestStr);
+}
+
+
+md5_context MD5_HashBuffer(void const *messagePtr, size_t byteCount)
+{
+    md5_context context;
+    MD5_InitializeContext(&context);
+
+    MD5_Update(&context, messagePtr, byteCount);
+    MD5_Final(&context);
+
+    return context;
+}
+
+
+md5_context MD5_HashString(char *messagePtr)
+{
+    return MD5_HashBuffer(messagePtr, strlen(messagePtr));
+}
+
+
+typedef struct
+{
+    md5_context *Context;
+    uint64_t BlockCount;
+    bool IsHashingTail;
+
+    // Note (Aaron): The message remainder, padding and message length are hashed from here
+    // once the lane has finished the message's whole blocks.
+    uint8_t TailBlocks[MD5_MESSAGE_BLOCK_SIZE * 2];
+    uint64_t TailBlockCount;
+} md5_multi_buffer_job;
+
+
+static void MD5_StartMultiBufferJob(md5_multi_buffer_state *state, uint32_t lane, md5_multi_buffer_job *job,
+                                    md5_context *context, void const *messagePtr, size_t byteCount)
+{
+    MD5_InitializeContext(context);
+
+    // Note (Aaron): MD5 only uses the low-order 64 bits of the message length
+    context->Hash.MessageLengthBits = (uint64_t)byteCount * 8;
+
+    uint32_t remainderByteCount = (uint32_t)(byteCount % MD5_MESSAGE_BLOCK_SIZE);
+    uint64_t wholeBlockByteCount = byteCount - remainderByteCount;
+
+    if (remainderByteCount > 0)
+    {
+        MD5_MemoryCopy(job->TailBlocks, (uint8_t const *)messagePtr + wholeBlockByteCount, remainderByteCount);
+    }
+
+    job->TailBlockCount = MD5_ApplyPadding(job->TailBlocks, remainderByteCount, context->Hash.MessageLengthBits) / MD5_MESSAGE_BLOCK_SIZE;
+    job->Context = context;
+
+    if (wholeBlockByteCount > 0)
+    {
+        state->BlockPtrs[lane] = (uint8_t const *)messagePtr;
+        job->BlockCount = wholeBlockByteCount / MD5_MESSAGE_BLOCK_SIZE;
+        job->IsHashingTail = false;
+    }
+    else
+    {
+        state->BlockPtrs[lane] = job->TailBlocks;
+        job->BlockCount = job->TailBlockCount;
+        job->IsHashingTail = true;
+    }
+
+    for (int i = 0; i < 4; ++i)
+    {
+        state->State[i][lane] = context->Hash.State[i];
+    }
+}
+
+
+static void MD5_FinishMultiBufferJob(md5_multi_buffer_state *state, uint32_t lane, md5_multi_buffer_job *job)
+{
+    md5_context *context = job->Context;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        context->Hash.State[i] = state->State[i][lane];
+    }
+
+    MD5_ConstructDigest(context);
+
+    // Zero out message remainder to prevent sensitive information being left in memory
+    if (!context->Hash.DisableScrubbing)
+    {
+        MD5_SecureZero(job->TailBlocks, sizeof(job->TailBlocks));
+    }
+}
+
+
+// Note (Aaron): Keeps every lane of the kernel busy by refilling lanes with the next message as soon
+// as their current message is finished. Each kernel call runs the fewest blocks any active lane has
+// left, so lanes only ever idle once no messages remain.
+static void MD5_HashBuffersMultiBuffer(md5_context *contexts, void const * const *messagePtrs, size_t const *byteCounts,
+                                       size_t count, md5_multi_buffer_kernel *kernel, uint32_t laneCount)
+{
+    md5_assert(laneCount <= MD5_MULTI_BUFFER_MAX_LANES);
+
+    md5_multi_buffer_state state;
+    md5_multi_buffer_job jobs[MD5_MULTI_BUFFER_MAX_LANES];
+
+    // Note (Aaron): The contexts a batch produces start out scrubbing, so the kernels scrub too
+    state.DisableScrubbing = false;
+
+    for (uint32_t lane = 0; lane < MD5_MULTI_BUFFER_MAX_LANES; ++lane)
+    {
+        state.BlockPtrs[lane] = MD5_IdleMessageBlock;
+    }
+
+    uint32_t laneMask = 0;
+    size_t nextMessage = 0;
+
+    for (;;)
+    {
+        // Refill idle lanes with the next messages
+        for (uint32_t lane = 0; lane < laneCount && nextMessage < count; ++lane)
+        {
+            if (!(laneMask & (1 << lane)))
+            {
+                MD5_StartMultiBufferJob(&state, lane, &jobs[lane], &contexts[nextMessage],
+                                        messagePtrs[nextMessage], byteCounts[nextMessage]);
+                laneMask |= (1 << lane);
+                nextMessage++;
+            }
+        }
+
+        if (laneMask == 0)
+        {
+            break;
+        }
+
+        uint64_t blockCount = UINT64_MAX;
+        for (uint32_t lane = 0; lane < laneCount; ++lane)
+        {
+            if ((laneMask & (1 << lane)) && jobs[lane].BlockCount < blockCount)
+            {
+                blockCount = jobs[lane].BlockCount;
+            }
+        }
+
+        kernel(&state, laneMask, blockCount);
+
+        for (uint32_t lane = 0; lane < laneCount; ++lane)
+        {
+            if (!(laneMask & (1 << lane)))
+            {
+                continue;
+            }
+
+            md5_multi_buffer_job *job = &jobs[lane];
+            job->BlockCount -= blockCount;
+
+            if (job->BlockCount > 0)
+            {
+                continue;
+            }
+
+            if (!job->IsHashingTail)
+            {
+                state.BlockPtrs[lane] = job->TailBlocks;
+                job->BlockCount = job->TailBlockCount;
+                job->IsHashingTail = true;
+                continue;
+            }
+
+            MD5_FinishMultiBufferJob(&state, lane, job);
+            state.BlockPtrs[lane] = MD5_IdleMessageBlock;
+            laneMask &= ~(1 << lane);
+        }
+    }
+}
+
+
+void MD5_HashBuffers(md5_context *contexts, void const * const *messagePtrs, size_t const *byteCounts, size_t count)
+{
+#if MD5_X64
+    if (count > 1 && MD5_HasCPUFeatures(MD5_CPU_FEATURE_AVX512F) && MD5_IsKernelAllowed("avx512"))
+    {
+        MD5_HashBuffersMultiBuffer(contexts, messagePtrs, byteCounts, count, MD5_UpdateHashx16AVX512, 16);
+        return;
+    }
+
+    if (count > 1 && MD5_HasCPUFeatures(MD5_CPU_FEATURE_AVX2) && MD5_IsKernelAllowed("avx2"))
+    {
+        MD5_HashBuffersMultiBuffer(contexts, messagePtrs, byteCounts, count, MD5_UpdateHashx8AVX2, 8);
+        return;
+    }
+#endif
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        contexts[i] = MD5_HashBuffer(messagePtrs[i], byteCounts[i]);
+    }
+}
+
+
+md5_context MD5_HashFile(const char *fileName)
+{
+    md5_context result;
+    MD5_InitializeContext(&result);
+
+    FILE *file = fopen(fileName, "rb");
+    if (!file)
+    {
+        md5_assert(false);
+
+        result.Error = true;
+        sprintf(result.ErrorStr, "Unable to open file");
+        sprintf(result.DigestStr, "");
+        return result;
+    }
+
+    // Note (Aaron): Read the file many message blocks at a time so that MD5_Update() can
+    // hash whole blocks in bulk. Short reads are fine as the remainder is buffered.
+    uint8_t buffer[MD5_MESSAGE_BLOCK_SIZE * MD5_FILE_READ_BLOCK_COUNT];
+    size_t bytesRead = fread(buffer, sizeof(uint8_t), sizeof(buffer), file);
+    while (bytesRead > 0 && !result.Error)
+    {
+        MD5_Update(&result, buffer, bytesRead);
+        bytesRead = fread(buffer, sizeof(uint8_t), sizeof(buffer), file);
+    }
+
+    if (ferror(file))
+    {
+        fclose(file);
+        md5_assert(false);
+
+        result.Error = true;
+        sprintf(result.ErrorStr, "Error reading file");
+        sprintf(result.DigestStr, "");
+        return result;
+    }
+
+    fclose(file);
 
     // Zero out buffer to sanitize potentially sensitive information
-    MD5_MemorySet(bufferPtr, 0, blockBytesRead);
+    MD5_SecureZero(buffer, sizeof(buffer));
 
-    // Calculate hash and return
-    MD5_ConstructDigest(&result);
+    MD5_Final(&result);
 
     return result;
 }
@@ -0,0 +1,696 @@
+/*  multihash.h - Computes MD5, SHA1 and SHA256 digests in a single pass over a message.
+
+    Do this:
+      #define HASHUTIL_MULTIHASH_IMPLEMENTATION
+   before you include this file in *one* C or C++ file to create the implementation. md5.h,
+   sha1.h and sha2.h must be included first. The implementation is built from their round
+   macros, so their implementations must be created in the same file.
+
+    Messages that arrive in pieces can be hashed by calling MULTIHASH_Init() once,
+    MULTIHASH_Update() for each piece and MULTIHASH_Final() to write the digests into the
+    MD5, SHA1 and SHA256 contexts held by the multihash context.
+
+    On CPUs with the SHA extensions each message block is hashed by a stitched kernel that
+    interleaves the three compression functions: the SHA1 and SHA256 rounds run on the SHA unit
+    while the MD5 steps run on the integer units. Other CPUs hash the blocks in three separate
+    passes with each algorithm's best kernel, since stitching the scalar kernels measured no
+    faster. The kernel is picked once at runtime. Setting HASHUTIL_FORCE_KERNEL to "shani" or
+    "separate" restricts hashing to that kernel, and any other name is passed on to the three
+    separate passes. MULTIHASH_GetKernelName() returns the name of the kernel in use.
+*/
+
+#ifndef HASHUTIL_MULTIHASH_H
+#define HASHUTIL_MULTIHASH_H
+
+// Note (Aaron): md5.h, sha1.h and sha2.h are not included here because including them again
+// would repeat their implementations.
+#if !defined(HASHUTIL_MD5_H) || !defined(HASHUTIL_SHA1_H) || !defined(HASHUTIL_SHA2_H)
+#error "Include md5.h, sha1.h and sha2.h before multihash.h"
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+static uint32_t const HASHUTIL_MULTIHASH_VERSION = 1;
+
+typedef struct
+{
+    md5_context MD5;
+    sha1_context SHA1;
+    sha2_256_context SHA256;
+
+    // Note (Aaron): Set to true after MULTIHASH_Init() to skip zeroing message data and intermediate
+    // state in all three contexts once it has been hashed.
+    bool DisableScrubbing;
+
+    bool Error;
+    char ErrorStr[64];
+} multihash_context;
+
+
+// Note (Aaron): Exported from shared library builds that use -fvisibility=hidden
+#if !defined(MULTIHASH_API)
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(_WIN32)
+#define MULTIHASH_API __attribute__((visibility("default")))
+#else
+#define MULTIHASH_API
+#endif
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+MULTIHASH_API uint32_t MULTIHASH_GetVersion();
+MULTIHASH_API char const *MULTIHASH_GetKernelName();
+MULTIHASH_API multihash_context MULTIHASH_HashString(char *messagePtr);
+MULTIHASH_API multihash_context MULTIHASH_HashFile(const char *fileName);
+MULTIHASH_API multihash_context MULTIHASH_HashBuffer(void const *messagePtr, size_t byteCount);
+
+MULTIHASH_API void MULTIHASH_Init(multihash_context *context);
+MULTIHASH_API void MULTIHASH_Update(multihash_context *context, void const *messagePtr, size_t byteCount);
+MULTIHASH_API void MULTIHASH_Final(multihash_context *context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HASHUTIL_MULTIHASH_H
+// end of header file ////////////////////////////////////////////////////////
+
+
+#ifdef HASHUTIL_MULTIHASH_IMPLEMENTATION
+
+#if !defined(HASHUTIL_MD5_IMPLEMENTATION) || !defined(HASHUTIL_SHA1_IMPLEMENTATION) || !defined(HASHUTIL_SHA2_IMPLEMENTATION)
+#error "multihash.h needs the md5.h, sha1.h and sha2.h implementations in the same file"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+
+#if HASHUTIL_SLOW
+#include <assert.h>
+#define multihash_assert(expression) assert(expression)
+#else
+#define multihash_assert(expression)
+#endif
+
+// Note (Aaron): MD5, SHA1 and SHA256 all use 512 bit message blocks
+#define MULTIHASH_MESSAGE_BLOCK_SIZE 64
+#define MULTIHASH_FILE_READ_BLOCK_COUNT 64
+
+// Note (Aaron): The SHA extensions kernel reuses the CPU feature detection from sha2.h
+#define MULTIHASH_X64 SHA2_X64
+#define MULTIHASH_TARGET(features) SHA2_TARGET(features)
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t MULTIHASH_GetVersion()
+{
+    uint32_t result = HASHUTIL_MULTIHASH_VERSION;
+    return result;
+}
+
+
+static void MULTIHASH_InitializeContext(multihash_context *context)
+{
+    MD5_InitializeContext(&context->MD5);
+    SHA1_InitializeContext(&context->SHA1);
+    SHA2_InitializeContextSHA256(&context->SHA256);
+
+    context->DisableScrubbing = false;
+    context->Error = false;
+    MD5_MemorySet((uint8_t *)context->ErrorStr, 0, sizeof(context->ErrorStr));
+}
+
+
+// Marks the multihash context and all three digests as failed
+static void MULTIHASH_SetError(multihash_context *context, char const *errorStr)
+{
+    context->Error = true;
+    sprintf(context->ErrorStr, "%s", errorStr);
+
+    context->MD5.Error = true;
+    sprintf(context->MD5.ErrorStr, "%s", errorStr);
+    context->MD5.DigestStr[0] = '\0';
+
+    context->SHA1.Error = true;
+    sprintf(context->SHA1.ErrorStr, "%s", errorStr);
+    context->SHA1.DigestStr[0] = '\0';
+
+    context->SHA256.Error = true;
+    sprintf(context->SHA256.ErrorStr, "%s", errorStr);
+    context->SHA256.DigestStr[0] = '\0';
+}
+
+
+// Picks up an error raised by one of the algorithms' own update or final functions
+static void MULTIHASH_CheckErrors(multihash_context *context)
+{
+    if (context->MD5.Error)
+    {
+        MULTIHASH_SetError(context, context->MD5.ErrorStr);
+    }
+    else if (context->SHA1.Error)
+    {
+        MULTIHASH_SetError(context, context->SHA1.ErrorStr);
+    }
+    else if (context->SHA256.Error)
+    {
+        MULTIHASH_SetError(context, context->SHA256.ErrorStr);
+    }
+}
+
+
+// Partial blocks and padding go through each algorithm's own functions, which scrub according to
+// their own contexts
+static void MULTIHASH_ApplyScrubbing(multihash_context *context)
+{
+    context->MD5.Hash.DisableScrubbing = context->DisableScrubbing;
+    context->SHA1.Hash.DisableScrubbing = context->DisableScrubbing;
+    context->SHA256.Hash.DisableScrubbing = context->DisableScrubbing;
+}
+
+
+// Note (Aaron): Hashes the blocks once per algorithm with each one's own kernel, which also applies
+// HASHUTIL_FORCE_KERNEL per algorithm. Stitched scalar and BMI2 kernels measured no faster than these
+// three passes: the three states need more registers than x86-64 has, so the interleave spills. The
+// message is walked in file read sized chunks so the second and third pass find it in the L1 cache.
+static void MULTIHASH_UpdateHashSeparate(multihash_context *context, uint8_t *messagePtr, uint64_t byteCount)
+{
+    multihash_assert(byteCount % MULTIHASH_MESSAGE_BLOCK_SIZE == 0);
+
+    uint64_t const chunkByteCount = MULTIHASH_FILE_READ_BLOCK_COUNT * MULTIHASH_MESSAGE_BLOCK_SIZE;
+    for (uint64_t i = 0; i < byteCount; i += chunkByteCount)
+    {
+        uint64_t passByteCount = (byteCount - i < chunkByteCount) ? (byteCount - i) : chunkByteCount;
+
+        MD5_UpdateHash(&context->MD5.Hash, messagePtr + i, passByteCount);
+        SHA1_UpdateHash(&context->SHA1.Hash, messagePtr + i, passByteCount);
+        SHA2_UpdateHashSHA256(&context->SHA256.Hash, messagePtr + i, passByteCount);
+    }
+}
+
+
+#if MULTIHASH_X64
+// Note (Aaron): The stitched kernel keeps the MD5 state in MD5A-MD5D and X[] holds its message words
+#define MULTIHASH_MD5_STEP(f, a, b, c, d, k, s, t) \
+    MD5_SCALAR_STEP(f, MD5##a, MD5##b, MD5##c, MD5##d, k, s, t)
+
+// SHA256 rounds 't' to 't + 3' that also finish the schedule words in 'next' and start the words
+// in 'previous'. Rounds 12-51 all have this shape.
+#define MULTIHASH_SHANI_SCHEDULED_ROUNDS_SHA256(message, t, next, previous) \
+    SHA2_SHANI_ROUNDS_SHA256(message, t); \
+    SHA2_SHANI_SCHEDULE_SHA256(next, message, previous); \
+    previous = _mm_sha256msg1_epu32(previous, message)
+
+// Note (Aaron): The 20 groups of four SHA1 rounds are spread over the 16 slices of four MD5 steps
+// and four SHA256 rounds by giving every fourth slice a second SHA1 group. The SHA1 and SHA256
+// sequences are the same as in SHA1_UpdateHashSHANI() and SHA2_UpdateHashSHA256SHANI().
+MULTIHASH_TARGET("sha,sse4.1,ssse3")
+static void MULTIHASH_UpdateHashSHANI(multihash_context *context, uint8_t *messagePtr, uint64_t byteCount)
+{
+    multihash_assert(byteCount % MULTIHASH_MESSAGE_BLOCK_SIZE == 0);
+
+    uint32_t X[16];
+
+    uint32_t MD5A = context->MD5.Hash.State[0];
+    uint32_t MD5B = context->MD5.Hash.State[1];
+    uint32_t MD5C = context->MD5.Hash.State[2];
+    uint32_t MD5D = context->MD5.Hash.State[3];
+
+    // Byte shuffles that reverse the block for SHA1 and convert each word to big endian for SHA256
+    __m128i const sha1ByteSwapMask = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+    __m128i const sha256ByteSwapMask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    __m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128((__m128i const *)&context->SHA1.Hash.H[0]), 0x1b);
+    __m128i e0 = _mm_set_epi32((int)context->SHA1.Hash.H4, 0, 0, 0);
+    __m128i e1;
+
+    // Note (Aaron): The SHA extensions expect the SHA256 state packed as ABEF and CDGH
+    __m128i temp = _mm_loadu_si128((__m128i const *)&context->SHA256.Hash.H[0]);
+    __m128i state1 = _mm_loadu_si128((__m128i const *)&context->SHA256.Hash.H[4]);
+
+    temp = _mm_shuffle_epi32(temp, 0xb1);               // CDAB
+    state1 = _mm_shuffle_epi32(state1, 0x1b);           // EFGH
+    __m128i state0 = _mm_alignr_epi8(temp, state1, 8);  // ABEF
+    state1 = _mm_blend_epi16(state1, temp, 0xf0);       // CDGH
+
+    __m128i roundInput;
+
+    // Iterate over blocks of the message
+    // 'i' holds the current block's byte position in the message
+    for (uint64_t i = 0; i < byteCount; i += MULTIHASH_MESSAGE_BLOCK_SIZE)
+    {
+        __m128i savedAbcd = abcd;
+        __m128i savedE0 = e0;
+        __m128i savedState0 = state0;
+        __m128i savedState1 = state1;
+
+        __m128i block0 = _mm_loadu_si128((__m128i const *)(messagePtr + i + 0));
+        __m128i block1 = _mm_loadu_si128((__m128i const *)(messagePtr + i + 16));
+        __m128i block2 = _mm_loadu_si128((__m128i const *)(messagePtr + i + 32));
+        __m128i block3 = _mm_loadu_si128((__m128i const *)(messagePtr + i + 48));
+
+        // Note (Aaron): x86-64 is little endian, so the MD5 message words are the block as is
+        _mm_storeu_si128((__m128i *)&X[0], block0);
+        _mm_storeu_si128((__m128i *)&X[4], block1);
+        _mm_storeu_si128((__m128i *)&X[8], block2);
+        _mm_storeu_si128((__m128i *)&X[12], block3);
+
+        __m128i sha1Message0 = _mm_shuffle_epi8(block0, sha1ByteSwapMask);
+        __m128i sha1Message1 = _mm_shuffle_epi8(block1, sha1ByteSwapMask);
+        __m128i sha1Message2 = _mm_shuffle_epi8(block2, sha1ByteSwapMask);
+        __m128i sha1Message3 = _mm_shuffle_epi8(block3, sha1ByteSwapMask);
+
+        __m128i sha256Message0 = _mm_shuffle_epi8(block0, sha256ByteSwapMask);
+        __m128i sha256Message1 = _mm_shuffle_epi8(block1, sha256ByteSwapMask);
+        __m128i sha256Message2 = _mm_shuffle_epi8(block2, sha256ByteSwapMask);
+        __m128i sha256Message3 = _mm_shuffle_epi8(block3, sha256ByteSwapMask);
+
+        // Slice 0
+        MD5_STEPS4_0(MULTIHASH_MD5_STEP)
+        e0 = _mm_add_epi32(e0, sha1Message0);
+        e1 = abcd;
+        abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+        SHA2_SHANI_ROUNDS_SHA256(sha256Message0, 0);
+
+        // Slice 1
+        MD5_STEPS4_1(MULTIHASH_MD5_STEP)
+        SHA1_SHANI_ROUNDS(e1, e0, sha1Message1, 0);
+        sha1Message0 = _mm_sha1msg1_epu32(sha1Message0, sha1Message1);
+        SHA2_SHANI_ROUNDS_SHA256(sha256Message1, 4);
+        sha256Message0 = _mm_sha256msg1_epu32(sha256Message0, sha256Message1);
+
+        // Slice 2
+        MD5_STEPS4_2(MULTIHASH_MD5_STEP)
+        SHA1_SHANI_ROUNDS(e0, e1, sha1Message2, 0);
+        sha1Message1 = _mm_sha1msg1_epu32(sha1Message1, sha1Message2);
+        sha1Message0 = _mm_xor_si128(sha1Message0, sha1Message2);
+        SHA2_SHANI_ROUNDS_SHA256(sha256Message2, 8);
+        sha256Message1 = _mm_sha256msg1_epu32(sha256Message1, sha256Message2);
+
+        // Slice 3
+        MD5_STEPS4_3(MULTIHASH_MD5_STEP)
+        SHA1_SHANI_SCHEDULED_ROUNDS(e1, e0, sha1Message3, sha1Message0, sha1Message2, sha1Message1, 0);
+        SHA1_SHANI_SCHEDULED_ROUNDS(e0, e1, sha1Message0, sha1Message1, sha1Message3, sha1Message2, 0);
+        MULTIHASH_SHANI_SCHEDULED_ROUNDS_SHA256(sha256Message3, 12, sha256Message0, sha256Message2);
+
+        // Slice 4
+        MD5_STEPS4_4(MULTIHASH_MD5_STEP)
+        SHA1_SHANI_SCHEDULED_ROUNDS(e1, e0, sha1Message1, sha1Message2, sha1Message0, sha1Message3, 1);
+        MULTIHASH_SHANI_SCHEDULED_ROUNDS_SHA256(sha256Message0, 16, sha256Message1, sha256Message3);
+
+        // Slice 5
+        MD5_STEPS4_5(MULTIHASH_MD5_STEP)
+        SHA1_SHANI_SCHEDULED_ROUNDS(e0, e1, sha1Message2, sha1Message3, sha1Message1, sha1Message0, 1);
+        MULTIHASH_SHANI_SCHEDULED_ROUNDS_SHA256(sha256Message1, 20, sha256Message2, sha256Message0);
+
+        // Slice 6
+        MD5_STEPS4_6(MULTIHASH_MD5_STEP)
+        SHA1_SHANI_SCHEDULED_ROUNDS(e1, e0, sha1Message3, sha1Message0, sha1Message2, sha1Message1, 1);
+        MULTIHASH_SHANI_SCHEDULED_ROUNDS_SHA256(sha256Message2, 24, sha256Message3, sha256Message1);
+
+        // Slice 7
+        MD5_STEPS4_7(MULTIHASH_MD5_STEP)
+        SHA1_SHANI_SCHEDULED_ROUNDS(e0, e1, sha1Message0, sha1Message1, sha1Message3, sha1Message2, 1);
+        SHA1_SHANI_SCHEDULED_ROUNDS(e1, e0, sha1Message1, sha1Message2, sha1Message0, sha1Message3, 1);
+        MULTIHASH_SHANI_SCHEDULED_ROUNDS_SHA256(sha256Message3, 28, sha256Message0, sha256Message2);
+
+        // Slice 8
+        MD5_STEPS4_8(MULTIHASH_MD5_STEP)
+        SHA1_SHANI_SCHEDULED_ROUNDS(e0, e1, sha1Message2, sha1Message3, sha1Message1, sha1Message0, 2);
+        MULTIHASH_SHANI_SCHEDULED_ROUNDS_SHA256(sha256Message0, 32, sha256Message1, sha256Message3);
+
+        // Slice 9
+        MD5_STEPS4_9(MULTIHASH_MD5_STEP)
+        SHA1_SHANI_SCHEDULED_ROUNDS(e1, e0, sha1Message3, sha1Message0, sha1Message2, sha1Message1, 2);
+        MULTIHASH_SHANI_SCHEDULED_ROUNDS_SHA256(sha256Message1, 36, sha256Message2, sha256Message0);
+
+        // Slice 10
+        MD5_STEPS4_10(MULTIHASH_MD5_STEP)
+        SHA1_SHANI_SCHEDULED_ROUNDS(e0, e1, sha1Message0, sha1Message1, sha1Message3, sha1Message2, 2);
+        MULTIHASH_SHANI_SCHEDULED_ROUNDS_SHA256(sha256Message2, 40, sha256Message3, sha256Message1);
+
+        // Slice 11
+        MD5_STEPS4_11(MULTIHASH_MD5_STEP)
+        SHA1_SHANI_SCHEDULED_ROUNDS(e1, e0, sha1Message1, sha1Message2, sha1Message0, sha1Message3, 2);
+        SHA1_SHANI_SCHEDULED_ROUNDS(e0, e1, sha1Message2, sha1Message3, sha1Message1, sha1Message0, 2);
+        MULTIHASH_SHANI_SCHEDULED_ROUNDS_SHA256(sha256Message3, 44, sha256Message0, sha256Message2);
+
+        // Slice 12
+        MD5_STEPS4_12(MULTIHASH_MD5_STEP)
+        SHA1_SHANI_SCHEDULED_ROUNDS(e1, e0, sha1Message3, sha1Message0, sha1Message2, sha1Message1, 3);
+        MULTIHASH_SHANI_SCHEDULED_ROUNDS_SHA256(sha256Message0, 48, sha256Message1, sha256Message3);
+
+        // Slice 13
+        MD5_STEPS4_13(MULTIHASH_MD5_STEP)
+        SHA1_SHANI_SCHEDULED_ROUNDS(e0, e1, sha1Message0, sha1Message1, sha1Message3, sha1Message2, 3);
+        SHA2_SHANI_ROUNDS_SHA256(sha256Message1, 52);
+        SHA2_SHANI_SCHEDULE_SHA256(sha256Message2, sha256Message1, sha256Message0);
+
+        // Slice 14
+        MD5_STEPS4_14(MULTIHASH_MD5_STEP)
+        SHA1_SHANI_ROUNDS(e1, e0, sha1Message1, 3);
+        sha1Message2 = _mm_sha1msg2_epu32(sha1Message2, sha1Message1);
+        sha1Message3 = _mm_xor_si128(sha1Message3, sha1Message1);
+        SHA2_SHANI_ROUNDS_SHA256(sha256Message2, 56);
+        SHA2_SHANI_SCHEDULE_SHA256(sha256Message3, sha256Message2, sha256Message1);
+
+        // Slice 15
+        MD5_STEPS4_15(MULTIHASH_MD5_STEP)
+        SHA1_SHANI_ROUNDS(e0, e1, sha1Message2, 3);
+        sha1Message3 = _mm_sha1msg2_epu32(sha1Message3, sha1Message2);
+        SHA1_SHANI_ROUNDS(e1, e0, sha1Message3, 3);
+        SHA2_SHANI_ROUNDS_SHA256(sha256Message3, 60);
+
+        // Add this block's result to the intermediate hash values
+        MD5A = (context->MD5.Hash.State[0] += MD5A);
+        MD5B = (context->MD5.Hash.State[1] += MD5B);
+        MD5C = (context->MD5.Hash.State[2] += MD5C);
+        MD5D = (context->MD5.Hash.State[3] += MD5D);
+
+        e0 = _mm_sha1nexte_epu32(e0, savedE0);
+        abcd = _mm_add_epi32(abcd, savedAbcd);
+
+        state0 = _mm_add_epi32(state0, savedState0);
+        state1 = _mm_add_epi32(state1, savedState1);
+    }
+
+    _mm_storeu_si128((__m128i *)&context->SHA1.Hash.H[0], _mm_shuffle_epi32(abcd, 0x1b));
+    context->SHA1.Hash.H4 = (uint32_t)_mm_extract_epi32(e0, 3);
+
+    // Unpack ABEF and CDGH back into H0-H7
+    temp = _mm_shuffle_epi32(state0, 0x1b);             // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xb1);           // DCHG
+    state0 = _mm_blend_epi16(temp, state1, 0xf0);       // DCBA
+    state1 = _mm_alignr_epi8(state1, temp, 8);          // HGFE
+
+    _mm_storeu_si128((__m128i *)&context->SHA256.Hash.H[0], state0);
+    _mm_storeu_si128((__m128i *)&context->SHA256.Hash.H[4], state1);
+
+    // Zero out X[] to prevent sensitive information being left in memory
+    if (!context->DisableScrubbing)
+    {
+        MD5_SecureZero(X, sizeof(X));
+    }
+}
+#endif
+
+
+typedef void multihash_kernel(multihash_context *context, uint8_t *messagePtr, uint64_t byteCount);
+
+typedef struct
+{
+    char const *Name;
+    uint32_t RequiredFeatures;
+    multihash_kernel *Kernel;
+} multihash_kernel_info;
+
+// Note (Aaron): Kernels in order of preference. Like the sha2.h kernels they can be restricted
+// with the HASHUTIL_FORCE_KERNEL environment variable. The separate passes must come last.
+static multihash_kernel_info const MULTIHASH_Kernels[] =
+{
+#if MULTIHASH_X64
+    { "shani", SHA2_CPU_FEATURE_SHA | SHA2_CPU_FEATURE_SSE41 | SHA2_CPU_FEATURE_SSSE3, MULTIHASH_UpdateHashSHANI },
+#endif
+    { "separate", 0, MULTIHASH_UpdateHashSeparate },
+};
+
+
+// Picks the kernel named 'forcedName' if the CPU supports it, otherwise the preferred kernel
+static multihash_kernel_info const *MULTIHASH_SelectKernel(char const *forcedName)
+{
+    if (forcedName)
+    {
+        for (size_t i = 0; i < SHA2_ArrayCount(MULTIHASH_Kernels); ++i)
+        {
+            if ((strcmp(MULTIHASH_Kernels[i].Name, forcedName) == 0) && SHA2_IsKernelSupported(MULTIHASH_Kernels[i].RequiredFeatures))
+            {
+                return &MULTIHASH_Kernels[i];
+            }
+        }
+
+        // Note (Aaron): Any other name is meant for the kernels of the three algorithms, which only
+        // the separate passes go through
+        return &MULTIHASH_Kernels[SHA2_ArrayCount(MULTIHASH_Kernels) - 1];
+    }
+
+    for (size_t i = 0; i < SHA2_ArrayCount(MULTIHASH_Kernels); ++i)
+    {
+        if (SHA2_IsKernelSupported(MULTIHASH_Kernels[i].RequiredFeatures))
+        {
+            return &MULTIHASH_Kernels[i];
+        }
+    }
+
+    multihash_assert(false);
+    return &MULTIHASH_Kernels[SHA2_ArrayCount(MULTIHASH_Kernels) - 1];
+}
+
+
+static multihash_kernel_info const *MULTIHASH_GetKernelInfo()
+{
+    // Note (Aaron): The kernel is only selected once. Racing threads select the same kernel, and
+    // the cache is a single pointer that is loaded and stored atomically.
+    static void const *selectedKernel = 0;
+
+    multihash_kernel_info const *kernel = (multihash_kernel_info const *)SHA2_AtomicLoadPointer(&selectedKernel);
+    if (!kernel)
+    {
+        kernel = MULTIHASH_SelectKernel(SHA2_GetForcedKernelName());
+        SHA2_AtomicStorePointer(&selectedKernel, kernel);
+    }
+
+    return kernel;
+}
+
+
+#if SHA2_USE_IFUNC
+// Picks the MULTIHASH_UpdateHash() kernel when the dynamic loader relocates the module
+static multihash_kernel *MULTIHASH_ResolveUpdateHash()
+{
+    return MULTIHASH_GetKernelInfo()->Kernel;
+}
+
+static void MULTIHASH_UpdateHash(multihash_context *context, uint8_t *messagePtr, uint64_t byteCount) __attribute__((ifunc("MULTIHASH_ResolveUpdateHash")));
+#else
+static void MULTIHASH_UpdateHash(multihash_context *context, uint8_t *messagePtr, uint64_t byteCount)
+{
+    MULTIHASH_GetKernelInfo()->Kernel(context, messagePtr, byteCount);
+}
+#endif
+
+
+char const *MULTIHASH_GetKernelName()
+{
+    return MULTIHASH_GetKernelInfo()->Name;
+}
+
+
+void MULTIHASH_Init(multihash_context *context)
+{
+    MULTIHASH_InitializeContext(context);
+}
+
+
+void MULTIHASH_Update(multihash_context *context, void const *messagePtr, size_t byteCount)
+{
+    if (context->Error || byteCount == 0)
+    {
+        return;
+    }
+
+    MULTIHASH_ApplyScrubbing(context);
+    uint8_t *bytePtr = (uint8_t *)messagePtr;
+
+    // Note (Aaron): The three contexts always see the same bytes, so they hold the same number of
+    // buffered bytes. Partial message blocks go through each algorithm's own update function.
+    multihash_assert(context->MD5.Hash.MessageBlockByteCount == context->SHA1.Hash.MessageBlockByteCount);
+    multihash_assert(context->MD5.Hash.MessageBlockByteCount == context->SHA256.Hash.MessageBlockByteCount);
+
+    // Top up a partially filled message block before touching the new data
+    if (context->MD5.Hash.MessageBlockByteCount > 0)
+    {
+        size_t fillByteCount = MULTIHASH_MESSAGE_BLOCK_SIZE - context->MD5.Hash.MessageBlockByteCount;
+        if (fillByteCount > byteCount)
+        {
+            fillByteCount = byteCount;
+        }
+
+        MD5_Update(&context->MD5, bytePtr, fillByteCount);
+        SHA1_Update(&context->SHA1, bytePtr, fillByteCount);
+        SHA2_UpdateSHA256(&context->SHA256, bytePtr, fillByteCount);
+        MULTIHASH_CheckErrors(context);
+
+        bytePtr += fillByteCount;
+        byteCount -= fillByteCount;
+
+        if (context->Error || byteCount == 0)
+        {
+            return;
+        }
+    }
+
+    // Process all whole message blocks directly from the caller's memory with the selected kernel
+    size_t wholeBlockByteCount = byteCount - (byteCount % MULTIHASH_MESSAGE_BLOCK_SIZE);
+    if (wholeBlockByteCount > 0)
+    {
+        // Note (Aaron): SHA1 and SHA256 count the same number of bits, MD5 lets the length wrap around
+        if ((uint64_t)wholeBlockByteCount > ((UINT64_MAX - context->SHA1.Hash.MessageLengthBits) / 8))
+        {
+            multihash_assert(false);
+
+            MULTIHASH_SetError(context, "Invalid message length: larger than 2^64-1 bits");
+            return;
+        }
+
+        context->MD5.Hash.MessageLengthBits += ((uint64_t)wholeBlockByteCount * 8);
+        context->SHA1.Hash.MessageLengthBits += ((uint64_t)wholeBlockByteCount * 8);
+        context->SHA256.Hash.MessageLengthBits += ((uint64_t)wholeBlockByteCount * 8);
+
+        MULTIHASH_UpdateHash(context, bytePtr, wholeBlockByteCount);
+        bytePtr += wholeBlockByteCount;
+        byteCount -= wholeBlockByteCount;
+    }
+
+    // Hold on to the message remainder until more data arrives or the hashes are finalized
+    if (byteCount > 0)
+    {
+        MD5_Update(&context->MD5, bytePtr, byteCount);
+        SHA1_Update(&context->SHA1, bytePtr, byteCount);
+        SHA2_UpdateSHA256(&context->SHA256, bytePtr, byteCount);
+        MULTIHASH_CheckErrors(context);
+    }
+}
+
+
+void MULTIHASH_Final(multihash_context *context)
+{
+    if (context->Error)
+    {
+        return;
+    }
+
+    MULTIHASH_ApplyScrubbing(context);
+
+    // Note (Aaron): At most two padded message blocks are left per algorithm, so they are not stitched
+    MD5_Final(&context->MD5);
+    SHA1_Final(&context->SHA1);
+    SHA2_FinalSHA256(&context->SHA256);
+    MULTIHASH_CheckErrors(context);
+}
+
+
+multihash_context MULTIHASH_HashBuffer(void const *messagePtr, size_t byteCount)
+{
+    multihash_context context;
+    MULTIHASH_InitializeContext(&context);
+
+    MULTIHASH_Update(&context, messagePtr, byteCount);
+    MULTIHASH_Final(&context);
+
+    return context;
+}
+
+
+multihash_context MULTIHASH_HashString(char *messagePtr)
+{
+    return MULTIHASH_HashBuffer(messagePtr, strlen(messagePtr));
+}
+
+
+multihash_context MULTIHASH_HashFile(const char *fileName)
+{
+    multihash_context context;
+    MULTIHASH_InitializeContext(&context);
+
+    FILE *file = fopen(fileName, "rb");
+    if (!file)
+    {
+        multihash_assert(false);
+
+        MULTIHASH_SetError(&context, "Unable to open file");
+        return context;
+    }
+
+    // Note (Aaron): Read the file many message blocks at a time so that MULTIHASH_Update() can
+    // hash whole blocks in bulk. Short reads are fine as the remainder is buffered.
+    uint8_t buffer[MULTIHASH_MESSAGE_BLOCK_SIZE * MULTIHASH_FILE_READ_BLOCK_COUNT];
+    size_t bytesRead = fread(buffer, sizeof(uint8_t), sizeof(buffer), file);
+    while (bytesRead > 0 && !context.Error)
+    {
+        MULTIHASH_Update(&context, buffer, bytesRead);
+        bytesRead = fread(buffer, sizeof(uint8_t), sizeof(buffer), file);
+    }
+
+    if (ferror(file))
+    {
+        fclose(file);
+        multihash_assert(false);
+
+        MULTIHASH_SetError(&context, "Error reading file");
+        return context;
+    }
+
+    fclose(file);
+
+    // Zero out buffer to sanitize potentially sensitive information
+    MD5_SecureZero(buffer, sizeof(buffer));
+
+    MULTIHASH_Final(&context);
+
+    return context;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HASHUTIL_MULTIHASH_IMPLEMENTATION
+/*
+------------------------------------------------------------------------------
+This software is available under 2 licenses -- choose whichever you prefer.
+------------------------------------------------------------------------------
+ALTERNATIVE A - MIT License
+Copyright (c) 2023 Aaron Hnyduik
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+------------------------------------------------------------------------------
+ALTERNATIVE B - Public Domain (www.unlicense.org)
+This is free and unencumbered software released into the public domain.
+Anyone is free to copy, modify, publish, use, compile, sell, or distribute this
+software, either in source code form or as a compiled binary, for any purpose,
+commercial or non-commercial, and by any means.
+In jurisdictions that recognize copyright laws, the author or authors of this
+software dedicate any and all copyright interest in the software to the public
+domain. We make this dedication for the benefit of the public at large and to
+the detriment of our heirs and successors. We intend this dedication to be an
+overt act of relinquishment in perpetuity of all present and future rights to
+this software under copyright law.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------
+*/
@@ -10,6 +10,36 @@
     Do this:
       #define HASHUTIL_SHA2_IMPLEMENTATION
    before you include this file in *one* C or C++ file to create the implementation.
+
+    Messages that arrive in pieces can be hashed by calling SHA2_Init*() once, SHA2_Update*()
+    for each piece and SHA2_Final*() to write the digest into the context. For example,
+    SHA2_InitSHA384(), SHA2_UpdateSHA384() and SHA2_FinalSHA384().
+
+    When hashing many small messages, use SHA2_DigestBuffer*() or the SHA2_InitState*(),
+    SHA2_UpdateState*() and SHA2_FinalState*() functions instead. They work on the compact
+    sha2_256_state and sha2_512_state and write the binary digest, and optionally its hex string,
+    into buffers provided by the caller. Update failures are returned as sha2_result codes.
+
+    An in-progress state can be saved with SHA2_ExportStateSHA256() or SHA2_ExportStateSHA512() and
+    resumed with the matching SHA2_ImportState*() function, also in another process or on another
+    platform. The exported bytes have a fixed, versioned, big endian layout, record which variant is
+    being hashed and include any buffered message bytes. These functions work on the Hash member of
+    a sha2_256_state or sha2_512_state, or of the matching context.
+
+    Many independent messages can be hashed in one call with SHA2_HashBuffers*(). On CPUs
+    with AVX2 or AVX-512 the messages are hashed side by side, one message per vector lane.
+
+    Kernels are picked once at runtime from the CPU's features. Set the HASHUTIL_FORCE_KERNEL
+    environment variable to "scalar", "bmi2", "ssse3", "avx", "avx2", "avx512" or "shani" to
+    restrict hashing to that kernel. Names the CPU or this header does not support fall back to
+    the default choice. SHA2_GetKernelNameSHA256() and SHA2_GetKernelNameSHA512() return the
+    names of the kernels used for single messages.
+
+    To build the implementation into a shared library, compile it with -fvisibility=hidden so
+    only the SHA2_API functions are exported. On ELF targets, additionally define
+      HASHUTIL_USE_IFUNC
+    to have the dynamic loader select the kernel once when the library is loaded. Such builds
+    ignore HASHUTIL_FORCE_KERNEL since the loader selects kernels before the environment is set up.
 */
 
 #ifndef HASHUTIL_SHA2_H
@@ -17,6 +47,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 static uint32_t const HASHUTIL_SHA2_VERSION = 1;
 
@@ -98,9 +129,46 @@ typedef struct
     uint64_t MessageLengthBitsLow;
 }sha2_message_padding_info;
 
+// Note (Aaron): Aligns a struct member, and with it the struct, to the given byte boundary
+#if !defined(SHA2_ALIGN)
+#if defined(_MSC_VER) && !defined(__clang__)
+#define SHA2_ALIGN(n) __declspec(align(n))
+#else
+#define SHA2_ALIGN(n) __attribute__((aligned(n)))
+#endif
+#endif
+
+typedef enum
+{
+    SHA2_RESULT_OK = 0,
+    SHA2_RESULT_MESSAGE_TOO_LONG = 1,
+    SHA2_RESULT_INVALID_STATE = 2,
+} sha2_result;
+
+// Note (Aaron): Sizes of states written by SHA2_ExportStateSHA256() and SHA2_ExportStateSHA512().
+// The layout is fixed for a given SHA2_STATE_FORMAT_VERSION, with every integer stored big endian
+// like the SHA2 digests themselves. The digest length tells the variants of a family apart. The
+// SHA512 family message length stays below 2^67 bits, the 2^64 - 1 byte limit of its updates.
+//   SHA224, SHA256                         SHA512/224, SHA512/256, SHA384, SHA512
+//   0   4 bytes   "S256"                   0   4 bytes    "S512"
+//   4   uint32    Format version           4   uint32     Format version
+//   8   uint32    Digest length in bits    8   uint32     Digest length in bits
+//   12  uint32    H[0..7]                  12  uint64     H[0..7]
+//   44  uint64    Message length in bits   76  uint128    Message length in bits
+//   52  uint32    Buffered byte count      92  uint32     Buffered byte count
+//   56  64 bytes  Buffered message bytes   96  128 bytes  Buffered message bytes
+#define SHA2_STATE_FORMAT_VERSION 1
+#define SHA2_EXPORTED_STATE_SIZE_SHA256 120
+#define SHA2_EXPORTED_STATE_SIZE_SHA512 224
+
+// Note (Aaron): Everything the kernels touch while hashing. The message block comes first and
+// fills exactly one cache line, so nothing needs padding and the struct stays at 120 bytes when
+// it is embedded in a sha2_256_context.
 typedef struct
 {
-    uint64_t MessageLengthBits;
+    // Note (Aaron): Holds message bytes passed to SHA2_Update*() that do not yet fill a message block
+    uint8_t MessageBlock[SHA2_MESSAGE_BLOCK_SIZE_SHA256];
+
     union
     {
         uint32_t H[8];
@@ -116,14 +184,25 @@ typedef struct
             uint32_t H7;
         };
     };
-    char DigestStr[65];
-    bool Error;
-    char ErrorStr[64];
-} sha2_256_context;
+    uint64_t MessageLengthBits;
+
+    uint32_t MessageBlockByteCount;
+
+    // Note (Aaron): Digest the state was initialized for. It selects how many digest bytes
+    // SHA2_FinalStateSHA256() writes.
+    sha2_digest_length DigestLength;
 
+    // Note (Aaron): Set to true after SHA2_Init*() or SHA2_InitState*() to skip zeroing message data
+    // and intermediate state once it has been hashed. Only worth it for bulk hashing of non-secret data.
+    bool DisableScrubbing;
+} sha2_256_hash;
+
+// Note (Aaron): Same layout as sha2_256_hash with 64-bit words and two cache lines of message
+// block, which makes it 224 bytes
 typedef struct
 {
-    uint128_t MessageLengthBits;
+    uint8_t MessageBlock[SHA2_MESSAGE_BLOCK_SIZE_SHA512];
+
     union
     {
         uint64_t H[8];
@@ -139,29 +218,141 @@ typedef struct
             uint64_t H7;
         };
     };
+    uint128_t MessageLengthBits;
+
+    uint32_t MessageBlockByteCount;
+    sha2_digest_length DigestLength;
+
+    bool DisableScrubbing;
+} sha2_512_hash;
+
+// Note (Aaron): Standalone states for the SHA2_*State*() functions. They sit on a 64 byte boundary,
+// which puts the message block and the chaining state on cache lines of their own. Heap allocated
+// states need an aligned allocator such as aligned_alloc().
+typedef struct
+{
+    SHA2_ALIGN(64) sha2_256_hash Hash;
+} sha2_256_state;
+
+typedef struct
+{
+    SHA2_ALIGN(64) sha2_512_hash Hash;
+} sha2_512_state;
+
+typedef struct
+{
+    sha2_256_hash Hash;
+
+    // Note (Aaron): Holds Hash.DigestLength / 8 bytes once the digest has been constructed
+    uint8_t Digest[SHA2_DIGEST_LENGTH_SHA256 / 8];
+    char DigestStr[65];
+    bool Error;
+    char ErrorStr[64];
+} sha2_256_context;
+
+typedef struct
+{
+    sha2_512_hash Hash;
+
+    // Note (Aaron): Holds Hash.DigestLength / 8 bytes once the digest has been constructed
+    uint8_t Digest[SHA2_DIGEST_LENGTH_SHA512 / 8];
     char DigestStr[129];
     bool Error;
     char ErrorStr[64];
 } sha2_512_context;
 
+// Note (Aaron): Exported from shared library builds that use -fvisibility=hidden
+#if !defined(SHA2_API)
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(_WIN32)
+#define SHA2_API __attribute__((visibility("default")))
+#else
+#define SHA2_API
+#endif
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-uint32_t SHA2_GetVersion();
-sha2_256_context SHA2_HashStringSHA224(char *messagePtr);
-sha2_256_context SHA2_HashStringSHA256(char *messagePtr);
-sha2_256_context SHA2_HashFileSHA224(char *fileName);
-sha2_256_context SHA2_HashFileSHA256(char *fileName);
-
-sha2_512_context SHA2_HashStringSHA512_224(char *messagePtr);
-sha2_512_context SHA2_HashStringSHA512_256(char *messagePtr);
-sha2_512_context SHA2_HashStringSHA384(char *messagePtr);
-sha2_512_context SHA2_HashStringSHA512(char *messagePtr);
-sha2_512_context SHA2_HashFileSHA512_224(char *fileName);
-sha2_512_context SHA2_HashFileSHA512_256(char *fileName);
-sha2_512_context SHA2_HashFileSHA384(char *fileName);
-sha2_512_context SHA2_HashFileSHA512(char *fileName);
+SHA2_API uint32_t SHA2_GetVersion();
+SHA2_API char const *SHA2_GetKernelNameSHA256();
+SHA2_API char const *SHA2_GetKernelNameSHA512();
+SHA2_API sha2_256_context SHA2_HashStringSHA224(char *messagePtr);
+SHA2_API sha2_256_context SHA2_HashStringSHA256(char *messagePtr);
+SHA2_API sha2_256_context SHA2_HashFileSHA224(char *fileName);
+SHA2_API sha2_256_context SHA2_HashFileSHA256(char *fileName);
+SHA2_API sha2_256_context SHA2_HashBufferSHA224(void const *messagePtr, size_t byteCount);
+SHA2_API sha2_256_context SHA2_HashBufferSHA256(void const *messagePtr, size_t byteCount);
+SHA2_API void SHA2_HashBuffersSHA224(sha2_256_context *contexts, void const * const *messagePtrs, size_t const *byteCounts, size_t count);
+SHA2_API void SHA2_HashBuffersSHA256(sha2_256_context *contexts, void const * const *messagePtrs, size_t const *byteCounts, size_t count);
+
+SHA2_API sha2_512_context SHA2_HashStringSHA512_224(char *messagePtr);
+SHA2_API sha2_512_context SHA2_HashStringSHA512_256(char *messagePtr);
+SHA2_API sha2_512_context SHA2_HashStringSHA384(char *messagePtr);
+SHA2_API sha2_512_context SHA2_HashStringSHA512(char *messagePtr);
+SHA2_API sha2_512_context SHA2_HashFileSHA512_224(char *fileName);
+SHA2_API sha2_512_context SHA2_HashFileSHA512_256(char *fileName);
+SHA2_API sha2_512_context SHA2_HashFileSHA384(char *fileName);
+SHA2_API sha2_512_context SHA2_HashFileSHA512(char *fileName);
+SHA2_API sha2_512_context SHA2_HashBufferSHA512_224(void const *messagePtr, size_t byteCount);
+SHA2_API sha2_512_context SHA2_HashBufferSHA512_256(void const *messagePtr, size_t byteCount);
+SHA2_API sha2_512_context SHA2_HashBufferSHA384(void const *messagePtr, size_t byteCount);
+SHA2_API sha2_512_context SHA2_HashBufferSHA512(void const *messagePtr, size_t byteCount);
+SHA2_API void SHA2_HashBuffersSHA512_224(sha2_512_context *contexts, void const * const *messagePtrs, size_t const *byteCounts, size_t count);
+SHA2_API void SHA2_HashBuffersSHA512_256(sha2_512_context *contexts, void const * const *messagePtrs, size_t const *byteCounts, size_t count);
+SHA2_API void SHA2_HashBuffersSHA384(sha2_512_context *contexts, void const * const *messagePtrs, size_t const *byteCounts, size_t count);
+SHA2_API void SHA2_HashBuffersSHA512(sha2_512_context *contexts, void const * const *messagePtrs, size_t const *byteCounts, size_t count);
+
+SHA2_API void SHA2_InitSHA224(sha2_256_context *context);
+SHA2_API void SHA2_InitSHA256(sha2_256_context *context);
+SHA2_API void SHA2_UpdateSHA224(sha2_256_context *context, void const *messagePtr, size_t byteCount);
+SHA2_API void SHA2_UpdateSHA256(sha2_256_context *context, void const *messagePtr, size_t byteCount);
+SHA2_API void SHA2_FinalSHA224(sha2_256_context *context);
+SHA2_API void SHA2_FinalSHA256(sha2_256_context *context);
+
+SHA2_API void SHA2_InitSHA512_224(sha2_512_context *context);
+SHA2_API void SHA2_InitSHA512_256(sha2_512_context *context);
+SHA2_API void SHA2_InitSHA384(sha2_512_context *context);
+SHA2_API void SHA2_InitSHA512(sha2_512_context *context);
+SHA2_API void SHA2_UpdateSHA512_224(sha2_512_context *context, void const *messagePtr, size_t byteCount);
+SHA2_API void SHA2_UpdateSHA512_256(sha2_512_context *context, void const *messagePtr, size_t byteCount);
+SHA2_API void SHA2_UpdateSHA384(sha2_512_context *context, void const *messagePtr, size_t byteCount);
+SHA2_API void SHA2_UpdateSHA512(sha2_512_context *context, void const *messagePtr, size_t byteCount);
+SHA2_API void SHA2_FinalSHA512_224(sha2_512_context *context);
+SHA2_API void SHA2_FinalSHA512_256(sha2_512_context *context);
+SHA2_API void SHA2_FinalSHA384(sha2_512_context *context);
+SHA2_API void SHA2_FinalSHA512(sha2_512_context *context);
+
+// Note (Aaron): Hashes through a bare sha2_256_state or sha2_512_state and writes the digest to
+// caller-provided buffers, which avoids copying whole contexts around and formatting strings nobody
+// reads. digestPtr receives DigestLength / 8 bytes. digestStr is optional and receives twice as many
+// chars plus a null terminator. A failed update leaves the state unchanged.
+SHA2_API void SHA2_InitStateSHA224(sha2_256_state *state);
+SHA2_API void SHA2_InitStateSHA256(sha2_256_state *state);
+SHA2_API sha2_result SHA2_UpdateStateSHA256(sha2_256_state *state, void const *messagePtr, size_t byteCount);
+SHA2_API void SHA2_FinalStateSHA256(sha2_256_state *state, uint8_t *digestPtr, char *digestStr);
+SHA2_API sha2_result SHA2_DigestBufferSHA224(void const *messagePtr, size_t byteCount, uint8_t *digestPtr, char *digestStr);
+SHA2_API sha2_result SHA2_DigestBufferSHA256(void const *messagePtr, size_t byteCount, uint8_t *digestPtr, char *digestStr);
+
+SHA2_API void SHA2_InitStateSHA512_224(sha2_512_state *state);
+SHA2_API void SHA2_InitStateSHA512_256(sha2_512_state *state);
+SHA2_API void SHA2_InitStateSHA384(sha2_512_state *state);
+SHA2_API void SHA2_InitStateSHA512(sha2_512_state *state);
+SHA2_API sha2_result SHA2_UpdateStateSHA512(sha2_512_state *state, void const *messagePtr, size_t byteCount);
+SHA2_API void SHA2_FinalStateSHA512(sha2_512_state *state, uint8_t *digestPtr, char *digestStr);
+SHA2_API sha2_result SHA2_DigestBufferSHA512_224(void const *messagePtr, size_t byteCount, uint8_t *digestPtr, char *digestStr);
+SHA2_API sha2_result SHA2_DigestBufferSHA512_256(void const *messagePtr, size_t byteCount, uint8_t *digestPtr, char *digestStr);
+SHA2_API sha2_result SHA2_DigestBufferSHA384(void const *messagePtr, size_t byteCount, uint8_t *digestPtr, char *digestStr);
+SHA2_API sha2_result SHA2_DigestBufferSHA512(void const *messagePtr, size_t byteCount, uint8_t *digestPtr, char *digestStr);
+
+// Note (Aaron): Saves an in-progress hash so it can be resumed later or in another process, on any
+// platform. Buffered message bytes are part of the export, so treat it like the message itself.
+// The import functions reject buffers with the wrong format, version or digest length, or with
+// inconsistent counts, and reset DisableScrubbing to false.
+SHA2_API void SHA2_ExportStateSHA256(sha2_256_hash const *state, uint8_t *bufferPtr);
+SHA2_API sha2_result SHA2_ImportStateSHA256(sha2_256_hash *state, uint8_t const *bufferPtr);
+SHA2_API void SHA2_ExportStateSHA512(sha2_512_hash const *state, uint8_t *bufferPtr);
+SHA2_API sha2_result SHA2_ImportStateSHA512(sha2_512_hash *state, uint8_t const *bufferPtr);
 
 #ifdef __cplusplus
 }
@@ -174,6 +365,8 @@ sha2_512_context SHA2_HashFileSHA512(char *fileName);
 #ifdef HASHUTIL_SHA2_IMPLEMENTATION
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <stdbool.h>
 
 #if HASHUTIL_SLOW
@@ -187,6 +380,45 @@ sha2_512_context SHA2_HashFileSHA512(char *fileName);
 
 #define SHA2_ArrayCount(Array) (sizeof(Array) / sizeof((Array)[0]))
 
+#define SHA2_FILE_READ_BLOCK_COUNT 64
+
+// Note (Aaron): Hardware accelerated kernels are only built for x86-64. Define
+// HASHUTIL_DISABLE_SIMD to build the portable scalar kernels only.
+#if !defined(HASHUTIL_DISABLE_SIMD) && (defined(__x86_64__) || defined(_M_X64))
+#define SHA2_X64 1
+#else
+#define SHA2_X64 0
+#endif
+
+// Note (Aaron): Byte order of the target. Every MSVC target is little endian.
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define SHA2_BIG_ENDIAN 1
+#else
+#define SHA2_BIG_ENDIAN 0
+#endif
+
+#if SHA2_X64
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define SHA2_TARGET(features)
+#else
+#include <cpuid.h>
+#define SHA2_TARGET(features) __attribute__((target(features)))
+#endif
+#include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+// Note (Aaron): HASHUTIL_USE_IFUNC binds the SHA2_UpdateHash*() kernels when the module is loaded (ELF only)
+#if HASHUTIL_USE_IFUNC && defined(__ELF__) && (defined(__GNUC__) || defined(__clang__))
+#define SHA2_USE_IFUNC 1
+#else
+#define SHA2_USE_IFUNC 0
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -197,25 +429,174 @@ uint32_t SHA2_GetVersion()
     return result;
 }
 
+
+// Note (Aaron): The lazily computed caches below are each a single word that is loaded and stored
+// atomically, so a thread racing the first call sees either the "not computed" value or the
+// complete result, never one without the other.
+#if SHA2_X64
+static uint32_t SHA2_AtomicLoad32(uint32_t *ptr)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+#elif defined(_MSC_VER)
+    return (uint32_t)_InterlockedOr((long volatile *)ptr, 0);
+#else
+    return *(uint32_t volatile *)ptr;
+#endif
+}
+
+static void SHA2_AtomicStore32(uint32_t *ptr, uint32_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+#elif defined(_MSC_VER)
+    _InterlockedExchange((long volatile *)ptr, (long)value);
+#else
+    *(uint32_t volatile *)ptr = value;
+#endif
+}
+#endif
+
+static void const *SHA2_AtomicLoadPointer(void const **ptr)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+#elif defined(_MSC_VER)
+    return _InterlockedCompareExchangePointer((void * volatile *)ptr, 0, 0);
+#else
+    return *(void const * volatile *)ptr;
+#endif
+}
+
+static void SHA2_AtomicStorePointer(void const **ptr, void const *value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+#elif defined(_MSC_VER)
+    _InterlockedExchangePointer((void * volatile *)ptr, (void *)value);
+#else
+    *(void const * volatile *)ptr = value;
+#endif
+}
+
+#if SHA2_X64
+typedef enum
+{
+    SHA2_CPU_FEATURE_SSSE3 = (1 << 0),
+    SHA2_CPU_FEATURE_SSE41 = (1 << 1),
+    SHA2_CPU_FEATURE_SHA = (1 << 2),
+    SHA2_CPU_FEATURE_AVX2 = (1 << 3),
+    SHA2_CPU_FEATURE_AVX512F = (1 << 4),
+    SHA2_CPU_FEATURE_AVX512BW = (1 << 5),
+    SHA2_CPU_FEATURE_AVX = (1 << 6),
+    SHA2_CPU_FEATURE_BMI2 = (1 << 7),
+    SHA2_CPU_FEATURE_AVX512VL = (1 << 8),
+    SHA2_CPU_FEATURE_BMI1 = (1 << 9),
+} sha2_cpu_feature;
+
+// Note (Aaron): Set in the cached CPU features once CPUID has been queried
+#define SHA2_CPU_FEATURES_QUERIED 0x80000000u
+
+static void SHA2_CPUID(uint32_t leaf, uint32_t subleaf, uint32_t registers[4])
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    __cpuidex((int *)registers, (int)leaf, (int)subleaf);
+#else
+    __cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+}
+
+SHA2_TARGET("xsave")
+static uint64_t SHA2_XGETBV(uint32_t index)
+{
+    return _xgetbv(index);
+}
+
+static uint32_t SHA2_GetCPUFeatures()
+{
+    // Note (Aaron): CPUID is only queried once. Racing threads compute the same value, and the
+    // cached result only counts once SHA2_CPU_FEATURES_QUERIED is set in the same word.
+    static uint32_t features = 0;
+
+    uint32_t cachedFeatures = SHA2_AtomicLoad32(&features);
+    if (cachedFeatures & SHA2_CPU_FEATURES_QUERIED)
+    {
+        return cachedFeatures & ~SHA2_CPU_FEATURES_QUERIED;
+    }
+
+    uint32_t result = 0;
+    uint32_t registers[4] = {0};
+
+    SHA2_CPUID(0, 0, registers);
+    uint32_t maxLeaf = registers[0];
+
+    SHA2_CPUID(1, 0, registers);
+    if (registers[2] & (1 << 9)) result |= SHA2_CPU_FEATURE_SSSE3;
+    if (registers[2] & (1 << 19)) result |= SHA2_CPU_FEATURE_SSE41;
+
+    // Note (Aaron): AVX registers are only usable when the OS saves them on context switches
+    bool osSavesYMM = false;
+    bool osSavesZMM = false;
+    if (registers[2] & (1 << 27))
+    {
+        uint64_t enabledStates = SHA2_XGETBV(0);
+        osSavesYMM = (enabledStates & 0x06) == 0x06;
+        osSavesZMM = (enabledStates & 0xe6) == 0xe6;
+    }
+
+    if ((registers[2] & (1 << 28)) && osSavesYMM) result |= SHA2_CPU_FEATURE_AVX;
+
+    if (maxLeaf >= 7)
+    {
+        SHA2_CPUID(7, 0, registers);
+        if (registers[1] & (1 << 29)) result |= SHA2_CPU_FEATURE_SHA;
+        if ((registers[1] & (1 << 5)) && osSavesYMM) result |= SHA2_CPU_FEATURE_AVX2;
+        if (registers[1] & (1 << 3)) result |= SHA2_CPU_FEATURE_BMI1;
+        if (registers[1] & (1 << 8)) result |= SHA2_CPU_FEATURE_BMI2;
+        if ((registers[1] & (1 << 16)) && osSavesZMM) result |= SHA2_CPU_FEATURE_AVX512F;
+        if ((registers[1] & (1 << 30)) && osSavesZMM) result |= SHA2_CPU_FEATURE_AVX512BW;
+        if ((registers[1] & (1u << 31)) && osSavesZMM) result |= SHA2_CPU_FEATURE_AVX512VL;
+    }
+
+    SHA2_AtomicStore32(&features, result | SHA2_CPU_FEATURES_QUERIED);
+
+    return result;
+}
+
+static bool SHA2_HasCPUFeatures(uint32_t requiredFeatures)
+{
+    return (SHA2_GetCPUFeatures() & requiredFeatures) == requiredFeatures;
+}
+#endif
+
 static void *SHA2_MemoryCopy(void *destPtr, void const *sourcePtr, size_t size)
 {
     sha2_assert(size > 0);
 
-    unsigned char *source = (unsigned char *)sourcePtr;
-    unsigned char *dest = (unsigned char *)destPtr;
-    while(size--) *dest++ = *source++;
-
-    return destPtr;
+    return memcpy(destPtr, sourcePtr, size);
 }
 
+
 static void *SHA2_MemorySet(uint8_t *destPtr, int c, size_t count)
 {
     sha2_assert(count > 0);
 
-    unsigned char *dest = (unsigned char *)destPtr;
-    while(count--) *dest++ = (unsigned char)c;
+    return memset(destPtr, c, count);
+}
+
 
-    return destPtr;
+// Zeroes memory that held message data or hash state. Unlike a plain memset(), the compiler
+// does not remove it when the memory is never read again.
+static void SHA2_SecureZero(void *destPtr, size_t size)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    memset(destPtr, 0, size);
+    // Note (Aaron): The empty asm statement claims to read the zeroed memory so the memset() is kept
+    __asm__ __volatile__("" : : "r"(destPtr) : "memory");
+#else
+    volatile uint8_t *dest = (volatile uint8_t *)destPtr;
+    while (size--) *dest++ = 0;
+#endif
 }
 
 // 32-bit Circular bit shift right
@@ -230,186 +611,265 @@ static uint64_t SHA2_ROTR64(uint64_t value, uint8_t count)
     return (value >> count) | (value << (64 - count));
 }
 
-// TODO (Aaron): Change this to the form that filling W[] uses?
-// Swap endianness of 64 bit value
-static void SHA2_MirrorBits64(uint64_t *bits)
+static uint32_t SHA2_ByteSwap32(uint32_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap32(value);
+#elif defined(_MSC_VER)
+    return _byteswap_ulong(value);
+#else
+    return ((value >> 24) & 0xff)
+         | ((value >> 8) & 0xff00)
+         | ((value << 8) & 0xff0000)
+         | ((value << 24) & 0xff000000);
+#endif
+}
+
+static uint64_t SHA2_ByteSwap64(uint64_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap64(value);
+#elif defined(_MSC_VER)
+    return _byteswap_uint64(value);
+#else
+    return ((uint64_t)SHA2_ByteSwap32((uint32_t)value) << 32) | SHA2_ByteSwap32((uint32_t)(value >> 32));
+#endif
+}
+
+// Note (Aaron): Message words and message lengths go through memcpy() so unaligned pointers are
+// safe. On x86-64 each load compiles to a single movbe, or a load plus a bswap.
+static uint32_t SHA2_LoadBE32(uint8_t const *ptr)
 {
-    *bits = ((*bits >> 56) & 0xff)
-         | ((*bits >> 40) & 0xff00)
-         | ((*bits >> 24) & 0xff0000)
-         | ((*bits >> 8) & 0xff000000)
-         | ((*bits << 8) & 0xff00000000)
-         | ((*bits << 24) & 0xff0000000000)
-         | ((*bits << 40) & 0xff000000000000)
-         | ((*bits << 56) & 0xff00000000000000);
+    uint32_t value;
+    memcpy(&value, ptr, sizeof(value));
+    return SHA2_BIG_ENDIAN ? value : SHA2_ByteSwap32(value);
 }
 
-static bool SHA2_IsSystemLittleEndian()
+static uint64_t SHA2_LoadBE64(uint8_t const *ptr)
 {
-    uint32_t endianTest = 0xdeadbeef;
-    bool isLittleEndian = *(unsigned char *)&endianTest = 0xef;
+    uint64_t value;
+    memcpy(&value, ptr, sizeof(value));
+    return SHA2_BIG_ENDIAN ? value : SHA2_ByteSwap64(value);
+}
 
-    return isLittleEndian;
+static void SHA2_StoreBE32(uint8_t *ptr, uint32_t value)
+{
+    value = SHA2_BIG_ENDIAN ? value : SHA2_ByteSwap32(value);
+    memcpy(ptr, &value, sizeof(value));
 }
 
-static void SHA2_InitializeContextSHA224(sha2_256_context *context)
+static void SHA2_StoreBE64(uint8_t *ptr, uint64_t value)
+{
+    value = SHA2_BIG_ENDIAN ? value : SHA2_ByteSwap64(value);
+    memcpy(ptr, &value, sizeof(value));
+}
+
+static void SHA2_InitializeStateSHA224(sha2_256_hash *state)
 {
-    context->MessageLengthBits = 0;
+    state->MessageLengthBits = 0;
 
-    context->H[0] = 0xc1059ed8;
-    context->H[1] = 0x367cd507;
-    context->H[2] = 0x3070dd17;
-    context->H[3] = 0xf70e5939;
-    context->H[4] = 0xffc00b31;
-    context->H[5] = 0x68581511;
-    context->H[6] = 0x64f98fa7;
-    context->H[7] = 0xbefa4fa4;
+    state->H[0] = 0xc1059ed8;
+    state->H[1] = 0x367cd507;
+    state->H[2] = 0x3070dd17;
+    state->H[3] = 0xf70e5939;
+    state->H[4] = 0xffc00b31;
+    state->H[5] = 0x68581511;
+    state->H[6] = 0x64f98fa7;
+    state->H[7] = 0xbefa4fa4;
 
-    context->Error = false;
+    state->MessageBlockByteCount = 0;
+    state->DigestLength = SHA2_DIGEST_LENGTH_SHA224;
+    state->DisableScrubbing = false;
 
 #if HASHUTIL_SLOW
-    SHA2_MemorySet((uint8_t *)context->DigestStr, 0, sizeof(context->DigestStr));
-    SHA2_MemorySet((uint8_t *)context->ErrorStr, 0, sizeof(context->ErrorStr));
+    SHA2_MemorySet(state->MessageBlock, 0, sizeof(state->MessageBlock));
 #endif
 }
 
-static void SHA2_InitializeContextSHA256(sha2_256_context *context)
+static void SHA2_InitializeContextSHA224(sha2_256_context *context)
 {
-    context->MessageLengthBits = 0;
-
-    context->H[0] = 0x6a09e667;
-    context->H[1] = 0xbb67ae85;
-    context->H[2] = 0x3c6ef372;
-    context->H[3] = 0xa54ff53a;
-    context->H[4] = 0x510e527f;
-    context->H[5] = 0x9b05688c;
-    context->H[6] = 0x1f83d9ab;
-    context->H[7] = 0x5be0cd19;
-
+    SHA2_InitializeStateSHA224(&context->Hash);
     context->Error = false;
 
 #if HASHUTIL_SLOW
+    SHA2_MemorySet(context->Digest, 0, sizeof(context->Digest));
     SHA2_MemorySet((uint8_t *)context->DigestStr, 0, sizeof(context->DigestStr));
     SHA2_MemorySet((uint8_t *)context->ErrorStr, 0, sizeof(context->ErrorStr));
 #endif
 }
 
-static void SHA2_InitializeContextSHA512_224(sha2_512_context *context)
+static void SHA2_InitializeStateSHA256(sha2_256_hash *state)
 {
-    context->MessageLengthBits.High = 0;
-    context->MessageLengthBits.Low = 0;
+    state->MessageLengthBits = 0;
+
+    state->H[0] = 0x6a09e667;
+    state->H[1] = 0xbb67ae85;
+    state->H[2] = 0x3c6ef372;
+    state->H[3] = 0xa54ff53a;
+    state->H[4] = 0x510e527f;
+    state->H[5] = 0x9b05688c;
+    state->H[6] = 0x1f83d9ab;
+    state->H[7] = 0x5be0cd19;
+
+    state->MessageBlockByteCount = 0;
+    state->DigestLength = SHA2_DIGEST_LENGTH_SHA256;
+    state->DisableScrubbing = false;
 
-    context->H[0]= 0x8c3d37c819544da2;
-    context->H[1]= 0x73e1996689dcd4d6;
-    context->H[2]= 0x1dfab7ae32ff9c82;
-    context->H[3]= 0x679dd514582f9fcf;
-    context->H[4]= 0x0f6d2b697bd44da8;
-    context->H[5]= 0x77e36f7304c48942;
-    context->H[6]= 0x3f9d85a86a1d36c8;
-    context->H[7]= 0x1112e6ad91d692a1;
+#if HASHUTIL_SLOW
+    SHA2_MemorySet(state->MessageBlock, 0, sizeof(state->MessageBlock));
+#endif
+}
 
+static void SHA2_InitializeContextSHA256(sha2_256_context *context)
+{
+    SHA2_InitializeStateSHA256(&context->Hash);
     context->Error = false;
 
 #if HASHUTIL_SLOW
+    SHA2_MemorySet(context->Digest, 0, sizeof(context->Digest));
     SHA2_MemorySet((uint8_t *)context->DigestStr, 0, sizeof(context->DigestStr));
     SHA2_MemorySet((uint8_t *)context->ErrorStr, 0, sizeof(context->ErrorStr));
 #endif
 }
 
-static void SHA2_InitializeContextSHA512_256(sha2_512_context *context)
+static void SHA2_InitializeStateSHA512_224(sha2_512_hash *state)
 {
-    context->MessageLengthBits.High = 0;
-    context->MessageLengthBits.Low = 0;
+    state->MessageLengthBits.High = 0;
+    state->MessageLengthBits.Low = 0;
+
+    state->H[0]= 0x8c3d37c819544da2;
+    state->H[1]= 0x73e1996689dcd4d6;
+    state->H[2]= 0x1dfab7ae32ff9c82;
+    state->H[3]= 0x679dd514582f9fcf;
+    state->H[4]= 0x0f6d2b697bd44da8;
+    state->H[5]= 0x77e36f7304c48942;
+    state->H[6]= 0x3f9d85a86a1d36c8;
+    state->H[7]= 0x1112e6ad91d692a1;
+
+    state->MessageBlockByteCount = 0;
+    state->DigestLength = SHA2_DIGEST_LENGTH_SHA224;
+    state->DisableScrubbing = false;
 
-    context->H[0]= 0x22312194fc2bf72c;
-    context->H[1]= 0x9f555fa3c84c64c2;
-    context->H[2]= 0x2393b86b6f53b151;
-    context->H[3]= 0x963877195940eabd;
-    context->H[4]= 0x96283ee2a88effe3;
-    context->H[5]= 0xbe5e1e2553863992;
-    context->H[6]= 0x2b0199fc2c85b8aa;
-    context->H[7]= 0x0eb72ddc81c52ca2;
+#if HASHUTIL_SLOW
+    SHA2_MemorySet(state->MessageBlock, 0, sizeof(state->MessageBlock));
+#endif
+}
 
+static void SHA2_InitializeContextSHA512_224(sha2_512_context *context)
+{
+    SHA2_InitializeStateSHA512_224(&context->Hash);
     context->Error = false;
 
 #if HASHUTIL_SLOW
+    SHA2_MemorySet(context->Digest, 0, sizeof(context->Digest));
     SHA2_MemorySet((uint8_t *)context->DigestStr, 0, sizeof(context->DigestStr));
     SHA2_MemorySet((uint8_t *)context->ErrorStr, 0, sizeof(context->ErrorStr));
 #endif
 }
 
-static void SHA2_InitializeContextSHA384(sha2_512_context *context)
+static void SHA2_InitializeStateSHA512_256(sha2_512_hash *state)
 {
-    context->MessageLengthBits.High = 0;
-    context->MessageLengthBits.Low = 0;
+    state->MessageLengthBits.High = 0;
+    state->MessageLengthBits.Low = 0;
+
+    state->H[0]= 0x22312194fc2bf72c;
+    state->H[1]= 0x9f555fa3c84c64c2;
+    state->H[2]= 0x2393b86b6f53b151;
+    state->H[3]= 0x963877195940eabd;
+    state->H[4]= 0x96283ee2a88effe3;
+    state->H[5]= 0xbe5e1e2553863992;
+    state->H[6]= 0x2b0199fc2c85b8aa;
+    state->H[7]= 0x0eb72ddc81c52ca2;
+
+    state->MessageBlockByteCount = 0;
+    state->DigestLength = SHA2_DIGEST_LENGTH_SHA256;
+    state->DisableScrubbing = false;
 
-    context->H[0]= 0xcbbb9d5dc1059ed8;
-    context->H[1]= 0x629a292a367cd507;
-    context->H[2]= 0x9159015a3070dd17;
-    context->H[3]= 0x152fecd8f70e5939;
-    context->H[4]= 0x67332667ffc00b31;
-    context->H[5]= 0x8eb44a8768581511;
-    context->H[6]= 0xdb0c2e0d64f98fa7;
-    context->H[7]= 0x47b5481dbefa4fa4;
+#if HASHUTIL_SLOW
+    SHA2_MemorySet(state->MessageBlock, 0, sizeof(state->MessageBlock));
+#endif
+}
 
+static void SHA2_InitializeContextSHA512_256(sha2_512_context *context)
+{
+    SHA2_InitializeStateSHA512_256(&context->Hash);
     context->Error = false;
 
 #if HASHUTIL_SLOW
+    SHA2_MemorySet(context->Digest, 0, sizeof(context->Digest));
     SHA2_MemorySet((uint8_t *)context->DigestStr, 0, sizeof(context->DigestStr));
     SHA2_MemorySet((uint8_t *)context->ErrorStr, 0, sizeof(context->ErrorStr));
 #endif
 }
 
-static void SHA2_InitializeContextSHA512(sha2_512_context *context)
+static void SHA2_InitializeStateSHA384(sha2_512_hash *state)
 {
-    context->MessageLengthBits.High = 0;
-    context->MessageLengthBits.Low = 0;
+    state->MessageLengthBits.High = 0;
+    state->MessageLengthBits.Low = 0;
+
+    state->H[0]= 0xcbbb9d5dc1059ed8;
+    state->H[1]= 0x629a292a367cd507;
+    state->H[2]= 0x9159015a3070dd17;
+    state->H[3]= 0x152fecd8f70e5939;
+    state->H[4]= 0x67332667ffc00b31;
+    state->H[5]= 0x8eb44a8768581511;
+    state->H[6]= 0xdb0c2e0d64f98fa7;
+    state->H[7]= 0x47b5481dbefa4fa4;
+
+    state->MessageBlockByteCount = 0;
+    state->DigestLength = SHA2_DIGEST_LENGTH_SHA384;
+    state->DisableScrubbing = false;
 
-    context->H[0]= 0x6a09e667f3bcc908;
-    context->H[1]= 0xbb67ae8584caa73b;
-    context->H[2]= 0x3c6ef372fe94f82b;
-    context->H[3]= 0xa54ff53a5f1d36f1;
-    context->H[4]= 0x510e527fade682d1;
-    context->H[5]= 0x9b05688c2b3e6c1f;
-    context->H[6]= 0x1f83d9abfb41bd6b;
-    context->H[7]= 0x5be0cd19137e2179;
+#if HASHUTIL_SLOW
+    SHA2_MemorySet(state->MessageBlock, 0, sizeof(state->MessageBlock));
+#endif
+}
 
+static void SHA2_InitializeContextSHA384(sha2_512_context *context)
+{
+    SHA2_InitializeStateSHA384(&context->Hash);
     context->Error = false;
 
 #if HASHUTIL_SLOW
+    SHA2_MemorySet(context->Digest, 0, sizeof(context->Digest));
     SHA2_MemorySet((uint8_t *)context->DigestStr, 0, sizeof(context->DigestStr));
     SHA2_MemorySet((uint8_t *)context->ErrorStr, 0, sizeof(context->ErrorStr));
 #endif
 }
 
-void SHA2_IncrementUINT128(uint128_t *value, int64_t increment)
+static void SHA2_InitializeStateSHA512(sha2_512_hash *state)
 {
-    uint64_t low = value->Low;
-    value->Low += increment;
+    state->MessageLengthBits.High = 0;
+    state->MessageLengthBits.Low = 0;
+
+    state->H[0]= 0x6a09e667f3bcc908;
+    state->H[1]= 0xbb67ae8584caa73b;
+    state->H[2]= 0x3c6ef372fe94f82b;
+    state->H[3]= 0xa54ff53a5f1d36f1;
+    state->H[4]= 0x510e527fade682d1;
+    state->H[5]= 0x9b05688c2b3e6c1f;
+    state->H[6]= 0x1f83d9abfb41bd6b;
+    state->H[7]= 0x5be0cd19137e2179;
+
+    state->MessageBlockByteCount = 0;
+    state->DigestLength = SHA2_DIGEST_LENGTH_SHA512;
+    state->DisableScrubbing = false;
 
-    if (increment > 0 && value->Low < low)
-    {
-        value->High++;
-    }
-    else if (increment < 0 && value->Low > low)
-    {
-        value->High--;
-    }
+#if HASHUTIL_SLOW
+    SHA2_MemorySet(state->MessageBlock, 0, sizeof(state->MessageBlock));
+#endif
 }
 
-bool SHA2_UINT128GreaterThan(uint128_t lhv, uint128_t rhv)
+static void SHA2_InitializeContextSHA512(sha2_512_context *context)
 {
-    if (lhv.High > rhv.High)
-    {
-        return true;
-    }
-
-    if (lhv.High < rhv.High)
-    {
-        return false;
-    }
+    SHA2_InitializeStateSHA512(&context->Hash);
+    context->Error = false;
 
-    return lhv.Low > rhv.Low;
+#if HASHUTIL_SLOW
+    SHA2_MemorySet(context->Digest, 0, sizeof(context->Digest));
+    SHA2_MemorySet((uint8_t *)context->DigestStr, 0, sizeof(context->DigestStr));
+    SHA2_MemorySet((uint8_t *)context->ErrorStr, 0, sizeof(context->ErrorStr));
+#endif
 }
 
 uint32_t SHA2_CH_SHA256(uint32_t x, uint32_t y, uint32_t z)
@@ -511,945 +971,2828 @@ void SHA2_ApplyPadding(sha2_message_padding_info messageInfo)
     }
 
     // Append length of message in bits (in big endian)
-    uint64_t *sizePtr = (uint64_t *)paddingPtr;
-    uint64_t messageLengthBitsHigh = messageInfo.MessageLengthBitsHigh;
-    uint64_t messageLengthBitsLow = messageInfo.MessageLengthBitsLow;
-
-    if (SHA2_IsSystemLittleEndian())
-    {
-        SHA2_MirrorBits64(&messageLengthBitsHigh);
-        SHA2_MirrorBits64(&messageLengthBitsLow);
-    }
-
     switch(messageInfo.MessageLengthBlockSizeBytes)
     {
         case SHA2_MESSAGE_LENGTH_BLOCK_SHA256:
         {
-            *sizePtr = messageLengthBitsLow;
+            SHA2_StoreBE64(paddingPtr, messageInfo.MessageLengthBitsLow);
             break;
         }
         case SHA2_MESSAGE_LENGTH_BLOCK_SHA512:
         {
-            *sizePtr = messageLengthBitsHigh;
-            sizePtr+=1;
-            *sizePtr = messageLengthBitsLow;
+            SHA2_StoreBE64(paddingPtr, messageInfo.MessageLengthBitsHigh);
+            SHA2_StoreBE64(paddingPtr + sizeof(uint64_t), messageInfo.MessageLengthBitsLow);
             break;
         }
     }
 }
 
-static void SHA2_UpdateHashSHA256(sha2_256_context *context, uint8_t *messagePtr, uint64_t messageByteCount)
+// One SHA256 round on scalar registers. Callers rotate the variable names instead of moving values.
+#define SHA2_ROUND_SHA256(a, b, c, d, e, f, g, h, wk) \
+    t1 = (h) + SHA2_BSIG1_SHA256(e) + SHA2_CH_SHA256((e), (f), (g)) + (wk); \
+    d += t1; \
+    h = t1 + SHA2_BSIG0_SHA256(a) + SHA2_MAJ_SHA256((a), (b), (c))
+
+// Returns W[t] for round 't' of a block. Words past the first 16 are computed in place of W[t - 16].
+#define SHA2_SCALAR_WORD_SHA256(t) \
+    ((t) < 16 ? W[(t) & 15] \
+              : (W[(t) & 15] += SHA2_SSIG1_SHA256(W[((t) - 2) & 15]) + W[((t) - 7) & 15] + SHA2_SSIG0_SHA256(W[((t) - 15) & 15])))
+
+// Eight rounds starting at round 't'. The names of A-H are back in their original order afterwards.
+#define SHA2_SCALAR_ROUNDS8_SHA256(t) \
+    SHA2_ROUND_SHA256(A, B, C, D, E, F, G, H, K_SHA256[(t) + 0] + SHA2_SCALAR_WORD_SHA256((t) + 0)); \
+    SHA2_ROUND_SHA256(H, A, B, C, D, E, F, G, K_SHA256[(t) + 1] + SHA2_SCALAR_WORD_SHA256((t) + 1)); \
+    SHA2_ROUND_SHA256(G, H, A, B, C, D, E, F, K_SHA256[(t) + 2] + SHA2_SCALAR_WORD_SHA256((t) + 2)); \
+    SHA2_ROUND_SHA256(F, G, H, A, B, C, D, E, K_SHA256[(t) + 3] + SHA2_SCALAR_WORD_SHA256((t) + 3)); \
+    SHA2_ROUND_SHA256(E, F, G, H, A, B, C, D, K_SHA256[(t) + 4] + SHA2_SCALAR_WORD_SHA256((t) + 4)); \
+    SHA2_ROUND_SHA256(D, E, F, G, H, A, B, C, K_SHA256[(t) + 5] + SHA2_SCALAR_WORD_SHA256((t) + 5)); \
+    SHA2_ROUND_SHA256(C, D, E, F, G, H, A, B, K_SHA256[(t) + 6] + SHA2_SCALAR_WORD_SHA256((t) + 6)); \
+    SHA2_ROUND_SHA256(B, C, D, E, F, G, H, A, K_SHA256[(t) + 7] + SHA2_SCALAR_WORD_SHA256((t) + 7))
+
+// Note (Aaron): Only the last 16 schedule words are kept. W[t & 15] is replaced by W[t] in the
+// round that consumes it. 'attributes' lets the same body be compiled for other instruction sets.
+#define SHA2_DEFINE_SCALAR_KERNEL_SHA256(kernelName, attributes) \
+attributes \
+static void kernelName(sha2_256_hash *state, uint8_t *messagePtr, uint64_t messageByteCount) \
+{ \
+    sha2_assert(messageByteCount % SHA2_MESSAGE_BLOCK_SIZE_SHA256 == 0); \
+ \
+    uint32_t W[16]; \
+    uint32_t t1; \
+ \
+    uint32_t A = state->H0; \
+    uint32_t B = state->H1; \
+    uint32_t C = state->H2; \
+    uint32_t D = state->H3; \
+    uint32_t E = state->H4; \
+    uint32_t F = state->H5; \
+    uint32_t G = state->H6; \
+    uint32_t H = state->H7; \
+ \
+    /* Iterate over blocks of the message */ \
+    /* 'i' holds the current block's byte position in the message */ \
+    for (uint64_t i = 0; i < messageByteCount; i += SHA2_MESSAGE_BLOCK_SIZE_SHA256) \
+    { \
+        /* 'j' holds the word position from the start of the current block being processed */ \
+        for (int j = 0; j < 16; ++j) \
+        { \
+            W[j] = SHA2_LoadBE32(messagePtr + i + (j * 4)); \
+        } \
+ \
+        SHA2_SCALAR_ROUNDS8_SHA256(0); \
+        SHA2_SCALAR_ROUNDS8_SHA256(8); \
+        SHA2_SCALAR_ROUNDS8_SHA256(16); \
+        SHA2_SCALAR_ROUNDS8_SHA256(24); \
+        SHA2_SCALAR_ROUNDS8_SHA256(32); \
+        SHA2_SCALAR_ROUNDS8_SHA256(40); \
+        SHA2_SCALAR_ROUNDS8_SHA256(48); \
+        SHA2_SCALAR_ROUNDS8_SHA256(56); \
+ \
+        A = (state->H0 += A); \
+        B = (state->H1 += B); \
+        C = (state->H2 += C); \
+        D = (state->H3 += D); \
+        E = (state->H4 += E); \
+        F = (state->H5 += F); \
+        G = (state->H6 += G); \
+        H = (state->H7 += H); \
+    } \
+ \
+    /* Zero out W[] to prevent sensitive information being left in memory */ \
+    if (!state->DisableScrubbing) \
+    { \
+        SHA2_SecureZero(W, sizeof(W)); \
+    } \
+}
+
+SHA2_DEFINE_SCALAR_KERNEL_SHA256(SHA2_UpdateHashSHA256Scalar, )
+
+#if SHA2_X64
+// Note (Aaron): Compiling the scalar kernel for BMI1/BMI2 lets the compiler use RORX for the BSIG and
+// SSIG rotations, which neither reads nor writes flags and keeps its source intact, and ANDN for CH.
+SHA2_DEFINE_SCALAR_KERNEL_SHA256(SHA2_UpdateHashSHA256BMI2, SHA2_TARGET("bmi,bmi2"))
+#endif
+
+#if SHA2_X64
+// Four rounds using the SHA extensions. 'message' holds W[t..t+3] for the rounds.
+#define SHA2_SHANI_ROUNDS_SHA256(message, t) \
+    roundInput = _mm_add_epi32((message), _mm_loadu_si128((__m128i const *)(K_SHA256 + (t)))); \
+    state1 = _mm_sha256rnds2_epu32(state1, state0, roundInput); \
+    roundInput = _mm_shuffle_epi32(roundInput, 0x0e); \
+    state0 = _mm_sha256rnds2_epu32(state0, state1, roundInput)
+
+// Completes the next four schedule words in 'next' using the current and previous words
+#define SHA2_SHANI_SCHEDULE_SHA256(next, current, previous) \
+    next = _mm_sha256msg2_epu32(_mm_add_epi32((next), _mm_alignr_epi8((current), (previous), 4)), (current))
+
+SHA2_TARGET("sha,sse4.1,ssse3")
+static void SHA2_UpdateHashSHA256SHANI(sha2_256_hash *state, uint8_t *messagePtr, uint64_t messageByteCount)
 {
     sha2_assert(messageByteCount % SHA2_MESSAGE_BLOCK_SIZE_SHA256 == 0);
 
-    uint32_t A, B, C, D, E, F, G, H;
-#if HASHUTIL_SLOW
-    A = 0;
-    B = 0;
-    C = 0;
-    D = 0;
-    E = 0;
-    F = 0;
-    G = 0;
-    H = 0;
-#endif
+    // Byte shuffle that converts each 32-bit word of the message to big endian
+    __m128i const byteSwapMask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
 
-    uint32_t W[64];
-#if HASHUTIL_SLOW
-    SHA2_MemorySet((uint8_t *)W, 0, sizeof(W));
-#endif
+    // Note (Aaron): The SHA extensions expect the state packed as ABEF and CDGH
+    __m128i temp = _mm_loadu_si128((__m128i const *)&state->H[0]);
+    __m128i state1 = _mm_loadu_si128((__m128i const *)&state->H[4]);
 
-    uint32_t t1 = 0;
-    uint32_t t2 = 0;
+    temp = _mm_shuffle_epi32(temp, 0xb1);               // CDAB
+    state1 = _mm_shuffle_epi32(state1, 0x1b);           // EFGH
+    __m128i state0 = _mm_alignr_epi8(temp, state1, 8);  // ABEF
+    state1 = _mm_blend_epi16(state1, temp, 0xf0);       // CDGH
+
+    __m128i roundInput;
 
     // Iterate over blocks of the message
     // 'i' holds the current block's byte position in the message
-    for(uint64_t i = 0; i < messageByteCount; i+=SHA2_MESSAGE_BLOCK_SIZE_SHA256)
+    for (uint64_t i = 0; i < messageByteCount; i += SHA2_MESSAGE_BLOCK_SIZE_SHA256)
     {
-        // 'j' holds the word position from the start of the current block being processed
-        for (int j = 0; j < 16; ++j)
+        __m128i savedState0 = state0;
+        __m128i savedState1 = state1;
+
+        __m128i message0 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i const *)(messagePtr + i + 0)), byteSwapMask);
+        __m128i message1 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i const *)(messagePtr + i + 16)), byteSwapMask);
+        __m128i message2 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i const *)(messagePtr + i + 32)), byteSwapMask);
+        __m128i message3 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i const *)(messagePtr + i + 48)), byteSwapMask);
+
+        // Rounds 0-15 consume the message block directly
+        SHA2_SHANI_ROUNDS_SHA256(message0, 0);
+        SHA2_SHANI_ROUNDS_SHA256(message1, 4);
+        message0 = _mm_sha256msg1_epu32(message0, message1);
+        SHA2_SHANI_ROUNDS_SHA256(message2, 8);
+        message1 = _mm_sha256msg1_epu32(message1, message2);
+        SHA2_SHANI_ROUNDS_SHA256(message3, 12);
+        SHA2_SHANI_SCHEDULE_SHA256(message0, message3, message2);
+        message2 = _mm_sha256msg1_epu32(message2, message3);
+
+        // Rounds 16-47 expand the schedule four words at a time
+        for (int t = 16; t < 48; t += 16)
         {
-            // Convert from memory-order to message order. SHA256 is processed in 32bit words.
-            // If it used 8-bit blocks, there would be no need to re-order the message chunks.
-            // TODO (Aaron): I don't think this works regardless of the machine's endianness. Explore.
-            W[j] = ((uint32_t)*(messagePtr + i + (j * 4)) << 24)
-                 | ((uint32_t)*(messagePtr + i + (j * 4) + 1) << 16)
-                 | ((uint32_t)*(messagePtr + i + (j * 4) + 2) << 8)
-                 | ((uint32_t)*(messagePtr + i + (j * 4) + 3));
-        }
+            SHA2_SHANI_ROUNDS_SHA256(message0, t);
+            SHA2_SHANI_SCHEDULE_SHA256(message1, message0, message3);
+            message3 = _mm_sha256msg1_epu32(message3, message0);
 
-        for (int t = 16; t < SHA2_ArrayCount(W); ++t)
-        {
-            // Wt = SSIG1(W(t-2)) + W(t-7) + SSIG0(w(t-15)) + W(t-16)
-            W[t] = SHA2_SSIG1_SHA256(W[t-2]) + W[t-7] + SHA2_SSIG0_SHA256(W[t-15]) + W[t-16];
+            SHA2_SHANI_ROUNDS_SHA256(message1, t + 4);
+            SHA2_SHANI_SCHEDULE_SHA256(message2, message1, message0);
+            message0 = _mm_sha256msg1_epu32(message0, message1);
+
+            SHA2_SHANI_ROUNDS_SHA256(message2, t + 8);
+            SHA2_SHANI_SCHEDULE_SHA256(message3, message2, message1);
+            message1 = _mm_sha256msg1_epu32(message1, message2);
+
+            SHA2_SHANI_ROUNDS_SHA256(message3, t + 12);
+            SHA2_SHANI_SCHEDULE_SHA256(message0, message3, message2);
+            message2 = _mm_sha256msg1_epu32(message2, message3);
         }
 
-        A = context->H0;
-        B = context->H1;
-        C = context->H2;
-        D = context->H3;
-        E = context->H4;
-        F = context->H5;
-        G = context->H6;
-        H = context->H7;
+        // Rounds 48-63 only need to finish the last schedule words
+        SHA2_SHANI_ROUNDS_SHA256(message0, 48);
+        SHA2_SHANI_SCHEDULE_SHA256(message1, message0, message3);
+        message3 = _mm_sha256msg1_epu32(message3, message0);
+        SHA2_SHANI_ROUNDS_SHA256(message1, 52);
+        SHA2_SHANI_SCHEDULE_SHA256(message2, message1, message0);
+        SHA2_SHANI_ROUNDS_SHA256(message2, 56);
+        SHA2_SHANI_SCHEDULE_SHA256(message3, message2, message1);
+        SHA2_SHANI_ROUNDS_SHA256(message3, 60);
+
+        state0 = _mm_add_epi32(state0, savedState0);
+        state1 = _mm_add_epi32(state1, savedState1);
+    }
 
-        for (int t = 0; t < 64; ++t)
-        {
-            // T1 = h + BSIG1(e) + CH(e,f,g) + Kt + Wt
-            t1 = H + SHA2_BSIG1_SHA256(E) + SHA2_CH_SHA256(E, F, G) + K_SHA256[t] + W[t];
+    // Unpack ABEF and CDGH back into H0-H7
+    temp = _mm_shuffle_epi32(state0, 0x1b);             // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xb1);           // DCHG
+    state0 = _mm_blend_epi16(temp, state1, 0xf0);       // DCBA
+    state1 = _mm_alignr_epi8(state1, temp, 8);          // HGFE
 
-            // T2 = BSIG0_SHA256(a) + MAJ_SHA256(a,b,c)
-            t2 = SHA2_BSIG0_SHA256(A) + SHA2_MAJ_SHA256(A, B, C);
+    _mm_storeu_si128((__m128i *)&state->H[0], state0);
+    _mm_storeu_si128((__m128i *)&state->H[4], state1);
+}
+#endif
 
-            H = G;
-            G = F;
-            F = E;
-            E = D + t1;
-            D = C;
-            C = B;
-            B = A;
-            A = t1 + t2;
-        }
+#if SHA2_X64
+#define SHA2_ROUNDS4_SHA256(a, b, c, d, e, f, g, h, t) \
+    SHA2_ROUND_SHA256(a, b, c, d, e, f, g, h, WK[(t) + 0]); \
+    SHA2_ROUND_SHA256(h, a, b, c, d, e, f, g, WK[(t) + 1]); \
+    SHA2_ROUND_SHA256(g, h, a, b, c, d, e, f, WK[(t) + 2]); \
+    SHA2_ROUND_SHA256(f, g, h, a, b, c, d, e, WK[(t) + 3])
+
+#define SHA2_SSE_ROTR32(x, count) _mm_or_si128(_mm_srli_epi32((x), (count)), _mm_slli_epi32((x), 32 - (count)))
+
+#define SHA2_SSE_SSIG0_SHA256(x) \
+    _mm_xor_si128(_mm_xor_si128(SHA2_SSE_ROTR32((x), 7), SHA2_SSE_ROTR32((x), 18)), _mm_srli_epi32((x), 3))
+
+#define SHA2_SSE_SSIG1_SHA256(x) \
+    _mm_xor_si128(_mm_xor_si128(SHA2_SSE_ROTR32((x), 17), SHA2_SSE_ROTR32((x), 19)), _mm_srli_epi32((x), 10))
+
+// Computes W[t..t+3] into 'x0', which holds W[t-16..t-13] on entry, and stores W[t..t+3] + K[t..t+3].
+// W[t+2] and W[t+3] depend on W[t] and W[t+1], so SSIG1 is applied to the low and high halves in turn.
+#define SHA2_SSE_SCHEDULE_SHA256(x0, x1, x2, x3, t) \
+    schedule = _mm_add_epi32(_mm_add_epi32((x0), SHA2_SSE_SSIG0_SHA256(_mm_alignr_epi8((x1), (x0), 4))), \
+                             _mm_alignr_epi8((x3), (x2), 4)); \
+    schedule = _mm_add_epi32(schedule, _mm_and_si128(SHA2_SSE_SSIG1_SHA256(_mm_shuffle_epi32((x3), 0xee)), lowHalf)); \
+    x0 = _mm_add_epi32(schedule, _mm_and_si128(SHA2_SSE_SSIG1_SHA256(_mm_shuffle_epi32(schedule, 0x44)), highHalf)); \
+    _mm_storeu_si128((__m128i *)&WK[(t)], _mm_add_epi32((x0), _mm_loadu_si128((__m128i const *)&K_SHA256[(t)])))
+
+// Note (Aaron): Kernel that expands the message schedule four words at a time in vector registers
+// while the rounds run on scalar registers, so the two can overlap. The same body is compiled for
+// several instruction sets: the AVX builds use the non-destructive VEX encodings and the AVX2
+// build adds BMI2 so the rounds' rotations become RORX.
+#define SHA2_DEFINE_SIMD_SCHEDULE_KERNEL_SHA256(kernelName, features) \
+SHA2_TARGET(features) \
+static void kernelName(sha2_256_hash *state, uint8_t *messagePtr, uint64_t messageByteCount) \
+{ \
+    sha2_assert(messageByteCount % SHA2_MESSAGE_BLOCK_SIZE_SHA256 == 0); \
+ \
+    __m128i const byteSwapMask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL); \
+    __m128i const lowHalf = _mm_set_epi32(0, 0, -1, -1); \
+    __m128i const highHalf = _mm_set_epi32(-1, -1, 0, 0); \
+ \
+    uint32_t WK[64]; \
+    uint32_t t1; \
+    __m128i schedule; \
+ \
+    uint32_t A = state->H0; \
+    uint32_t B = state->H1; \
+    uint32_t C = state->H2; \
+    uint32_t D = state->H3; \
+    uint32_t E = state->H4; \
+    uint32_t F = state->H5; \
+    uint32_t G = state->H6; \
+    uint32_t H = state->H7; \
+ \
+    for (uint64_t i = 0; i < messageByteCount; i += SHA2_MESSAGE_BLOCK_SIZE_SHA256) \
+    { \
+        __m128i x0 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i const *)(messagePtr + i + 0)), byteSwapMask); \
+        __m128i x1 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i const *)(messagePtr + i + 16)), byteSwapMask); \
+        __m128i x2 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i const *)(messagePtr + i + 32)), byteSwapMask); \
+        __m128i x3 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i const *)(messagePtr + i + 48)), byteSwapMask); \
+ \
+        _mm_storeu_si128((__m128i *)&WK[0], _mm_add_epi32(x0, _mm_loadu_si128((__m128i const *)&K_SHA256[0]))); \
+        _mm_storeu_si128((__m128i *)&WK[4], _mm_add_epi32(x1, _mm_loadu_si128((__m128i const *)&K_SHA256[4]))); \
+        _mm_storeu_si128((__m128i *)&WK[8], _mm_add_epi32(x2, _mm_loadu_si128((__m128i const *)&K_SHA256[8]))); \
+        _mm_storeu_si128((__m128i *)&WK[12], _mm_add_epi32(x3, _mm_loadu_si128((__m128i const *)&K_SHA256[12]))); \
+ \
+        /* Rounds 0-47 each run alongside the expansion of the schedule words 16 rounds ahead */ \
+        for (int t = 0; t < 48; t += 16) \
+        { \
+            SHA2_SSE_SCHEDULE_SHA256(x0, x1, x2, x3, t + 16); \
+            SHA2_ROUNDS4_SHA256(A, B, C, D, E, F, G, H, t + 0); \
+            SHA2_SSE_SCHEDULE_SHA256(x1, x2, x3, x0, t + 20); \
+            SHA2_ROUNDS4_SHA256(E, F, G, H, A, B, C, D, t + 4); \
+            SHA2_SSE_SCHEDULE_SHA256(x2, x3, x0, x1, t + 24); \
+            SHA2_ROUNDS4_SHA256(A, B, C, D, E, F, G, H, t + 8); \
+            SHA2_SSE_SCHEDULE_SHA256(x3, x0, x1, x2, t + 28); \
+            SHA2_ROUNDS4_SHA256(E, F, G, H, A, B, C, D, t + 12); \
+        } \
+ \
+        SHA2_ROUNDS4_SHA256(A, B, C, D, E, F, G, H, 48); \
+        SHA2_ROUNDS4_SHA256(E, F, G, H, A, B, C, D, 52); \
+        SHA2_ROUNDS4_SHA256(A, B, C, D, E, F, G, H, 56); \
+        SHA2_ROUNDS4_SHA256(E, F, G, H, A, B, C, D, 60); \
+ \
+        A = (state->H0 += A); \
+        B = (state->H1 += B); \
+        C = (state->H2 += C); \
+        D = (state->H3 += D); \
+        E = (state->H4 += E); \
+        F = (state->H5 += F); \
+        G = (state->H6 += G); \
+        H = (state->H7 += H); \
+    } \
+ \
+    /* Zero out WK[] to prevent sensitive information being left in memory */ \
+    if (!state->DisableScrubbing) \
+    { \
+        SHA2_SecureZero(WK, sizeof(WK)); \
+    } \
+}
+
+SHA2_DEFINE_SIMD_SCHEDULE_KERNEL_SHA256(SHA2_UpdateHashSHA256SSSE3, "ssse3")
+SHA2_DEFINE_SIMD_SCHEDULE_KERNEL_SHA256(SHA2_UpdateHashSHA256AVX, "avx")
+SHA2_DEFINE_SIMD_SCHEDULE_KERNEL_SHA256(SHA2_UpdateHashSHA256AVX2, "avx2,bmi2")
+#endif
+
+// Returns the kernel name set in the HASHUTIL_FORCE_KERNEL environment variable, or 0 if it is not set
+static char const *SHA2_GetForcedKernelName()
+{
+#if SHA2_USE_IFUNC
+    // Note (Aaron): getenv() does not work yet when the ifunc resolvers run
+    return 0;
+#else
+    // Note (Aaron): 0 until the variable has been read. Afterwards the cache holds its value, or
+    // 'noForcedName' when it is not set.
+    static char const noForcedName[] = "";
+    static void const *forcedName = 0;
 
-        context->H0 += A;
-        context->H1 += B;
-        context->H2 += C;
-        context->H3 += D;
-        context->H4 += E;
-        context->H5 += F;
-        context->H6 += G;
-        context->H7 += H;
+    char const *name = (char const *)SHA2_AtomicLoadPointer(&forcedName);
+    if (!name)
+    {
+        char const *value = getenv("HASHUTIL_FORCE_KERNEL");
+        name = (value && value[0]) ? value : noForcedName;
+        SHA2_AtomicStorePointer(&forcedName, name);
     }
 
-    // TODO (Aaron): Any clean-up here? Zero-out W, A-H, and t1/t2?
+    return (name == noForcedName) ? 0 : name;
+#endif
 }
 
-static void SHA2_UpdateHashSHA512(sha2_512_context *context, uint8_t *messagePtr, uint64_t byteCount)
+
+// Returns true unless HASHUTIL_FORCE_KERNEL names a different kernel than 'name'
+static bool SHA2_IsKernelAllowed(char const *name)
 {
-    // Note (Aaron): Using a uint64_t type for 'byteCount' limits the maximum amount of data that can be
-    // passed through this method on one invocation to less than what the algorithm can support  but that's
-    // fine as it would be in the Pebibyte range and totally impractical.
+    char const *forcedName = SHA2_GetForcedKernelName();
+    return !forcedName || (strcmp(forcedName, name) == 0);
+}
 
-    sha2_assert(byteCount % SHA2_MESSAGE_BLOCK_SIZE_SHA512 == 0);
 
-    uint64_t A, B, C, D, E, F, G, H;
-#if HASHUTIL_SLOW
-    A = 0;
-    B = 0;
-    C = 0;
-    D = 0;
-    E = 0;
-    F = 0;
-    G = 0;
-    H = 0;
+static bool SHA2_IsKernelSupported(uint32_t requiredFeatures)
+{
+#if SHA2_X64
+    return SHA2_HasCPUFeatures(requiredFeatures);
+#else
+    return requiredFeatures == 0;
 #endif
+}
 
-    uint64_t W[80];
-#if HASHUTIL_SLOW
-    SHA2_MemorySet((uint8_t *)W, 0, sizeof(W));
+
+typedef void sha2_256_kernel(sha2_256_hash *state, uint8_t *messagePtr, uint64_t byteCount);
+
+typedef struct
+{
+    char const *Name;
+    uint32_t RequiredFeatures;
+    sha2_256_kernel *Kernel;
+} sha2_256_kernel_info;
+
+// Note (Aaron): Kernels in order of preference. The first kernel the CPU supports is used unless
+// HASHUTIL_FORCE_KERNEL names another supported kernel.
+static sha2_256_kernel_info const SHA2_KernelsSHA256[] =
+{
+#if SHA2_X64
+    { "shani", SHA2_CPU_FEATURE_SHA | SHA2_CPU_FEATURE_SSE41 | SHA2_CPU_FEATURE_SSSE3, SHA2_UpdateHashSHA256SHANI },
+    { "avx2", SHA2_CPU_FEATURE_AVX2 | SHA2_CPU_FEATURE_BMI2, SHA2_UpdateHashSHA256AVX2 },
+    { "avx", SHA2_CPU_FEATURE_AVX, SHA2_UpdateHashSHA256AVX },
+    { "ssse3", SHA2_CPU_FEATURE_SSSE3, SHA2_UpdateHashSHA256SSSE3 },
+    { "bmi2", SHA2_CPU_FEATURE_BMI1 | SHA2_CPU_FEATURE_BMI2, SHA2_UpdateHashSHA256BMI2 },
 #endif
+    { "scalar", 0, SHA2_UpdateHashSHA256Scalar },
+};
 
-    uint64_t t1 = 0;
-    uint64_t t2 = 0;
 
-    // Iterate over blocks of the message
-    // 'i' holds the current block's byte position in the message
-    for(uint64_t i = 0; i < byteCount; i+=SHA2_MESSAGE_BLOCK_SIZE_SHA512)
+// Picks the kernel named 'forcedName' if the CPU supports it, otherwise the preferred kernel
+static sha2_256_kernel_info const *SHA2_SelectKernelSHA256(char const *forcedName)
+{
+    if (forcedName)
     {
-        // 'j' holds the word position from the start of the current block being processed
-        for (int j = 0; j < 16; ++j)
+        for (size_t i = 0; i < SHA2_ArrayCount(SHA2_KernelsSHA256); ++i)
         {
-            // TODO (Aaron): Use a MirrorBits function here instead
-            W[j] = ((uint64_t)*(messagePtr + i + (j * 8) + 0) << 56)
-                | ((uint64_t)*(messagePtr + i + (j * 8) + 1) << 48)
-                | ((uint64_t)*(messagePtr + i + (j * 8) + 2) << 40)
-                | ((uint64_t)*(messagePtr + i + (j * 8) + 3) << 32)
-                | ((uint64_t)*(messagePtr + i + (j * 8) + 4) << 24)
-                | ((uint64_t)*(messagePtr + i + (j * 8) + 5) << 16)
-                | ((uint64_t)*(messagePtr + i + (j * 8) + 6) << 8)
-                | ((uint64_t)*(messagePtr + i + (j * 8) + 7));
+            if ((strcmp(SHA2_KernelsSHA256[i].Name, forcedName) == 0) && SHA2_IsKernelSupported(SHA2_KernelsSHA256[i].RequiredFeatures))
+            {
+                return &SHA2_KernelsSHA256[i];
+            }
         }
+    }
 
-        for (int t = 16; t < SHA2_ArrayCount(W); ++t)
+    for (size_t i = 0; i < SHA2_ArrayCount(SHA2_KernelsSHA256); ++i)
+    {
+        if (SHA2_IsKernelSupported(SHA2_KernelsSHA256[i].RequiredFeatures))
         {
-            // Wt = SSIG1(W(t-2)) + W(t-7) + SSIG0(W(t-15)) + W(t-16)
-            W[t] = SHA2_SSIG1_SHA512(W[t-2]) + W[t-7] + SHA2_SSIG0_SHA512(W[t-15]) + W[t-16];
+            return &SHA2_KernelsSHA256[i];
         }
+    }
 
-        A = context->H0;
-        B = context->H1;
-        C = context->H2;
-        D = context->H3;
-        E = context->H4;
-        F = context->H5;
-        G = context->H6;
-        H = context->H7;
+    sha2_assert(false);
+    return &SHA2_KernelsSHA256[SHA2_ArrayCount(SHA2_KernelsSHA256) - 1];
+}
 
-        for (int t = 0; t < SHA2_ArrayCount(W); ++t)
-        {
-            // T1 = h + BSIG1(e) + CH(e,f,g) + Kt + Wt
-            t1 = H + SHA2_BSIG1_SHA512(E) + SHA2_CH_SHA512(E, F, G) + K_SHA512[t] + W[t];
 
-            // T2 = BSIG0(a) + MAJ(a,b,c)
-            t2 = SHA2_BSIG0_SHA512(A) + SHA2_MAJ_SHA512(A, B, C);
+static sha2_256_kernel_info const *SHA2_GetKernelInfoSHA256()
+{
+    // Note (Aaron): The kernel is only selected once. Racing threads select the same kernel, and
+    // the cache is a single pointer that is loaded and stored atomically.
+    static void const *selectedKernel = 0;
 
-            H = G;
-            G = F;
-            F = E;
-            E = D + t1;
-            D = C;
-            C = B;
-            B = A;
-            A = t1 + t2;
-        }
-
-        context->H0 += A;
-        context->H1 += B;
-        context->H2 += C;
-        context->H3 += D;
-        context->H4 += E;
-        context->H5 += F;
-        context->H6 += G;
-        context->H7 += H;
+    sha2_256_kernel_info const *kernel = (sha2_256_kernel_info const *)SHA2_AtomicLoadPointer(&selectedKernel);
+    if (!kernel)
+    {
+        kernel = SHA2_SelectKernelSHA256(SHA2_GetForcedKernelName());
+        SHA2_AtomicStorePointer(&selectedKernel, kernel);
     }
 
-    // TODO (Aaron): Any clean-up here? Zero-out W, A-H, and t1/t2?
+    return kernel;
 }
 
-static void SHA2_ConstructDigestSHA224(sha2_256_context *context)
-{
-    // Assert buffer is large enough to hold a SHA224 digest
-    // (224 bits in hex, plus the string null terminator character)
-    sha2_static_assert(SHA2_ArrayCount(context->DigestStr) >= (224 / 4 + 1),
-                  "Buffer is not large enough to hold SHA224 digest");
-
-    sprintf(context->DigestStr,
-            "%08x%08x%08x%08x%08x%08x%08x",
-            context->H[0],
-            context->H[1],
-            context->H[2],
-            context->H[3],
-            context->H[4],
-            context->H[5],
-            context->H[6]);
-}
 
-static void SHA2_ConstructDigestSHA256(sha2_256_context *context)
+#if SHA2_USE_IFUNC
+// Picks the SHA2_UpdateHashSHA256() kernel when the dynamic loader relocates the module
+static sha2_256_kernel *SHA2_ResolveUpdateHashSHA256()
 {
-    // Assert buffer is large enough to hold a SHA256 digest
-    // (256 bits in hex, plus the string null terminator character)
-    sha2_static_assert(SHA2_ArrayCount(context->DigestStr) >= (256 / 4 + 1),
-                  "Buffer is not large enough to hold SHA256 digest");
-
-    sprintf(context->DigestStr,
-            "%08x%08x%08x%08x%08x%08x%08x%08x",
-            context->H[0],
-            context->H[1],
-            context->H[2],
-            context->H[3],
-            context->H[4],
-            context->H[5],
-            context->H[6],
-            context->H[7]);
+    return SHA2_GetKernelInfoSHA256()->Kernel;
 }
 
-static void SHA2_ConstructDigestSHA512_224(sha2_512_context *context)
+static void SHA2_UpdateHashSHA256(sha2_256_hash *state, uint8_t *messagePtr, uint64_t messageByteCount) __attribute__((ifunc("SHA2_ResolveUpdateHashSHA256")));
+#else
+static void SHA2_UpdateHashSHA256(sha2_256_hash *state, uint8_t *messagePtr, uint64_t messageByteCount)
 {
-    // Assert buffer is large enough to hold a SHA512/224 digest
-    // (224 bits in hex, plus the string null terminator character)
-    sha2_static_assert(SHA2_ArrayCount(context->DigestStr) >= (224 / 4 + 1),
-                  "Buffer is not large enough to hold SHA512/224 digest");
-
-    sprintf(context->DigestStr,
-            "%016llx%016llx%016llx%08llx",
-            context->H[0],
-            context->H[1],
-            context->H[2],
-            (context->H[3] >> 32));
+    SHA2_GetKernelInfoSHA256()->Kernel(state, messagePtr, messageByteCount);
 }
+#endif
 
-static void SHA2_ConstructDigestSHA512_256(sha2_512_context *context)
-{
-    // Assert buffer is large enough to hold a SHA512/256 digest
-    // (256 bits in hex, plus the string null terminator character)
-    sha2_static_assert(SHA2_ArrayCount(context->DigestStr) >= (256 / 4 + 1),
-                  "Buffer is not large enough to hold SHA512/256 digest");
 
-    sprintf(context->DigestStr,
-            "%016llx%016llx%016llx%016llx",
-            context->H[0],
-            context->H[1],
-            context->H[2],
-            context->H[3]);
+char const *SHA2_GetKernelNameSHA256()
+{
+    return SHA2_GetKernelInfoSHA256()->Name;
 }
 
-static void SHA2_ConstructDigestSHA384(sha2_512_context *context)
+// Note (Aaron): Multi-buffer kernels hash independent messages side by side with one message
+// per 32-bit vector lane. The hash state is stored transposed so that each H word of every
+// lane can be loaded into a single vector register.
+#define SHA2_MULTI_BUFFER_MAX_LANES 16
+
+typedef struct
 {
-    // Assert buffer is large enough to hold a SHA384 digest
-    // (384 bits in hex, plus the string null terminator character)
-    sha2_static_assert(SHA2_ArrayCount(context->DigestStr) >= (384 / 4 + 1),
-                  "Buffer is not large enough to hold SHA384 digest");
+    uint32_t H[8][SHA2_MULTI_BUFFER_MAX_LANES];
+    uint8_t const *BlockPtrs[SHA2_MULTI_BUFFER_MAX_LANES];
+    bool DisableScrubbing;
+} sha2_256_multi_buffer_state;
 
-    sprintf(context->DigestStr,
-            // TODO (Aaron): Look up this formatting to make sure it is correct
-            "%016llx%016llx%016llx%016llx%016llx%016llx",
-            context->H[0],
-            context->H[1],
-            context->H[2],
-            context->H[3],
-            context->H[4],
-            context->H[5]);
-}
+// Hashes 'blockCount' message blocks for every lane set in 'laneMask'. Lanes not set in the mask
+// must point at a readable message block and keep their state and block pointer unchanged.
+typedef void sha2_256_multi_buffer_kernel(sha2_256_multi_buffer_state *state, uint32_t laneMask, uint64_t blockCount);
 
-static void SHA2_ConstructDigestSHA512(sha2_512_context *context)
-{
-    // Assert buffer is large enough to hold a SHA512 digest
-    // (512 bits in hex, plus the string null terminator character)
-    sha2_static_assert(SHA2_ArrayCount(context->DigestStr) >= (512 / 4 + 1),
-                  "Buffer is not large enough to hold SHA512 digest");
+// Note (Aaron): Idle lanes read from this block so that the kernels never need to branch per lane
+static uint8_t const SHA2_IdleMessageBlock[SHA2_MESSAGE_BLOCK_SIZE_SHA512] = {0};
 
-    sprintf(context->DigestStr,
-            "%016llx%016llx%016llx%016llx%016llx%016llx%016llx%016llx",
-            context->H[0],
-            context->H[1],
-            context->H[2],
-            context->H[3],
-            context->H[4],
-            context->H[5],
-            context->H[6],
-            context->H[7]);
-}
+#if SHA2_X64
+#define SHA2_AVX2_ROTR32(x, count) \
+    _mm256_or_si256(_mm256_srli_epi32((x), (count)), _mm256_slli_epi32((x), 32 - (count)))
 
-sha2_256_context SHA2_HashStringSHA256_(char *messagePtr, sha2_digest_length digestLength)
-{
-    sha2_256_context context;
-    uint8_t messageBlockByteCount = 0;
-    sha2_static_assert(UINT8_MAX > (SHA2_MESSAGE_BLOCK_SIZE_SHA256 * 2),
-                       "messageBlockByteCount cannot fit within a uint8_t");
+#define SHA2_AVX2_CH_SHA256(x, y, z) \
+    _mm256_xor_si256(_mm256_and_si256((x), (y)), _mm256_andnot_si256((x), (z)))
 
-    switch (digestLength)
-    {
-        case SHA2_DIGEST_LENGTH_SHA224:
-        {
-            SHA2_InitializeContextSHA224(&context);
-            break;
-        }
-        case SHA2_DIGEST_LENGTH_SHA256:
-        {
-            SHA2_InitializeContextSHA256(&context);
-            break;
-        }
-        default:
-        {
-            sha2_assert(false);
+#define SHA2_AVX2_MAJ_SHA256(x, y, z) \
+    _mm256_or_si256(_mm256_and_si256((x), (y)), _mm256_and_si256((z), _mm256_or_si256((x), (y))))
 
-            context.Error = true;
-            sprintf(context.ErrorStr, "Invalid digest length for SHA256: %i", digestLength);
-            sprintf(context.DigestStr, "");
-            return context;
-        }
-    }
+#define SHA2_AVX2_BSIG0_SHA256(x) \
+    _mm256_xor_si256(_mm256_xor_si256(SHA2_AVX2_ROTR32((x), 2), SHA2_AVX2_ROTR32((x), 13)), SHA2_AVX2_ROTR32((x), 22))
 
-    // Iterate over message until we can no longer fill a message block
-    while (*messagePtr != 0x00)
-    {
-        sha2_assert(messageBlockByteCount < SHA2_MESSAGE_BLOCK_SIZE_SHA256);
-        uint64_t oldMessageLengthBits = context.MessageLengthBits;
+#define SHA2_AVX2_BSIG1_SHA256(x) \
+    _mm256_xor_si256(_mm256_xor_si256(SHA2_AVX2_ROTR32((x), 6), SHA2_AVX2_ROTR32((x), 11)), SHA2_AVX2_ROTR32((x), 25))
 
-        messagePtr++;
-        messageBlockByteCount++;
-        context.MessageLengthBits += 8;
+#define SHA2_AVX2_SSIG0_SHA256(x) \
+    _mm256_xor_si256(_mm256_xor_si256(SHA2_AVX2_ROTR32((x), 7), SHA2_AVX2_ROTR32((x), 18)), _mm256_srli_epi32((x), 3))
 
-        if (context.MessageLengthBits < oldMessageLengthBits)
-        {
-            sha2_assert(false);
+#define SHA2_AVX2_SSIG1_SHA256(x) \
+    _mm256_xor_si256(_mm256_xor_si256(SHA2_AVX2_ROTR32((x), 17), SHA2_AVX2_ROTR32((x), 19)), _mm256_srli_epi32((x), 10))
 
-            context.Error = true;
-            sprintf(context.ErrorStr, "Invalid message length: larger than 2^64-1 bits");
-            sprintf(context.DigestStr, "");
-            return context;
-        }
+// Transposes an 8x8 matrix of 32-bit words so that row 'i' holds word 'i' of every input row
+SHA2_TARGET("avx2")
+static void SHA2_Transpose8x8AVX2(__m256i *rows)
+{
+    __m256i t0 = _mm256_unpacklo_epi32(rows[0], rows[1]);
+    __m256i t1 = _mm256_unpackhi_epi32(rows[0], rows[1]);
+    __m256i t2 = _mm256_unpacklo_epi32(rows[2], rows[3]);
+    __m256i t3 = _mm256_unpackhi_epi32(rows[2], rows[3]);
+    __m256i t4 = _mm256_unpacklo_epi32(rows[4], rows[5]);
+    __m256i t5 = _mm256_unpackhi_epi32(rows[4], rows[5]);
+    __m256i t6 = _mm256_unpacklo_epi32(rows[6], rows[7]);
+    __m256i t7 = _mm256_unpackhi_epi32(rows[6], rows[7]);
+
+    __m256i u0 = _mm256_unpacklo_epi64(t0, t2);
+    __m256i u1 = _mm256_unpackhi_epi64(t0, t2);
+    __m256i u2 = _mm256_unpacklo_epi64(t1, t3);
+    __m256i u3 = _mm256_unpackhi_epi64(t1, t3);
+    __m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+    __m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+    __m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+    __m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+
+    rows[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+    rows[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+    rows[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+    rows[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+    rows[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+    rows[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+    rows[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+    rows[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+}
 
-        // Process the message in blocks of 512 bits (64 bytes or sixteen 32-bit words)
-        if (messageBlockByteCount == SHA2_MESSAGE_BLOCK_SIZE_SHA256)
-        {
-            SHA2_UpdateHashSHA256(&context, (uint8_t *)messagePtr - messageBlockByteCount, messageBlockByteCount);
-            messageBlockByteCount = 0;
-        }
-    }
+SHA2_TARGET("avx2")
+static void SHA2_UpdateHashSHA256x8AVX2(sha2_256_multi_buffer_state *state, uint32_t laneMask, uint64_t blockCount)
+{
+    sha2_assert(laneMask != 0);
+    sha2_assert(laneMask < (1 << 8));
 
-    // Allocate a buffer to store the message remainder + padding + message length
-    // Note (Aaron): We use a double sized buffer to cover the worst case scenario
-    // where the message remainder + padding + message length cannot fit into one
-    // message block.
-    uint8_t buffer[SHA2_MESSAGE_BLOCK_SIZE_SHA256 * 2];
-    uint8_t bufferSizeBytes = SHA2_MESSAGE_BLOCK_SIZE_SHA256 * 2;
-    sha2_static_assert(UINT8_MAX > (SHA2_MESSAGE_BLOCK_SIZE_SHA256 * 2),
-                       "bufferSizeBytes cannot fit within a uint8_t");
+    // Byte shuffle that converts each 32-bit word of the message to big endian
+    __m256i const byteSwapMask = _mm256_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL,
+                                                   0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
 
-#if HASHUTIL_SLOW
-    // Note (Aaron): Packing the buffer's bits with 1s for debug purposes
-    SHA2_MemorySet(buffer, 0xff, bufferSizeBytes);
-#endif
+    // Expand the lane mask into a vector mask used to discard results for idle lanes
+    __m256i const laneBits = _mm256_setr_epi32(1 << 0, 1 << 1, 1 << 2, 1 << 3, 1 << 4, 1 << 5, 1 << 6, 1 << 7);
+    __m256i const activeLanes = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32((int)laneMask), laneBits), laneBits);
 
-    // Copy message remainder (if any) into buffer
-    if (messageBlockByteCount > 0)
+    uint8_t const *blockPtrs[8];
+    uint64_t blockStrides[8];
+    for (int lane = 0; lane < 8; ++lane)
     {
-        SHA2_MemoryCopy(buffer, (uint8_t *)(messagePtr - messageBlockByteCount), messageBlockByteCount);
+        blockPtrs[lane] = state->BlockPtrs[lane];
+        blockStrides[lane] = (laneMask & (1 << lane)) ? SHA2_MESSAGE_BLOCK_SIZE_SHA256 : 0;
     }
 
-    // Apply padding to the final message block(s)
-    sha2_message_padding_info messageInfo =
+    __m256i initialH[8];
+    __m256i H[8];
+    for (int i = 0; i < 8; ++i)
     {
-        messageInfo.BufferPtr = buffer,
-        messageInfo.BufferSizeBytes = bufferSizeBytes,
-        messageInfo.BlockSizeBytes = SHA2_MESSAGE_BLOCK_SIZE_SHA256,
-        messageInfo.MessageRemainderSizeBytes = messageBlockByteCount,
-        messageInfo.MessageLengthBlockSizeBytes = SHA2_MESSAGE_LENGTH_BLOCK_SHA256,
-        messageInfo.MessageLengthBitsHigh = 0,
-        messageInfo.MessageLengthBitsLow = context.MessageLengthBits,
-    };
-
-    SHA2_ApplyPadding(messageInfo);
+        initialH[i] = _mm256_loadu_si256((__m256i const *)state->H[i]);
+        H[i] = initialH[i];
+    }
 
-    // Apply final hash update and construct the digest
-    bool useFullBuffer = messageBlockByteCount > (SHA2_MESSAGE_BLOCK_SIZE_SHA256 - SHA2_MESSAGE_LENGTH_BLOCK_SHA256 - 1);
-    messageBlockByteCount = useFullBuffer ? (bufferSizeBytes) : SHA2_MESSAGE_BLOCK_SIZE_SHA256;
-    SHA2_UpdateHashSHA256(&context, (uint8_t *)buffer, messageBlockByteCount);
+    __m256i W[64];
 
-    switch (digestLength)
+    for (uint64_t block = 0; block < blockCount; ++block)
     {
-        case SHA2_DIGEST_LENGTH_SHA224:
-        {
-            SHA2_ConstructDigestSHA224(&context);
-            break;
-        }
-        case SHA2_DIGEST_LENGTH_SHA256:
-        {
-            SHA2_ConstructDigestSHA256(&context);
-            break;
-        }
-        default:
+        // Load the first and second half of each lane's block and transpose them into W[0..15]
+        for (int lane = 0; lane < 8; ++lane)
         {
-            // Invalid digest length for SHA256. We should never reach this state here.
-            sha2_assert(false);
+            W[lane] = _mm256_loadu_si256((__m256i const *)(blockPtrs[lane] + 0));
+            W[lane + 8] = _mm256_loadu_si256((__m256i const *)(blockPtrs[lane] + 32));
+            blockPtrs[lane] += blockStrides[lane];
         }
-    }
 
-    return context;
-}
+        SHA2_Transpose8x8AVX2(W + 0);
+        SHA2_Transpose8x8AVX2(W + 8);
 
-sha2_256_context SHA2_HashFileSHA256_(char *fileName, sha2_digest_length digestLength)
-{
-    sha2_256_context context;
-    switch (digestLength)
-    {
-        case SHA2_DIGEST_LENGTH_SHA224:
+        for (int t = 0; t < 16; ++t)
         {
-            SHA2_InitializeContextSHA224(&context);
-            break;
+            W[t] = _mm256_shuffle_epi8(W[t], byteSwapMask);
         }
-        case SHA2_DIGEST_LENGTH_SHA256:
+
+        for (int t = 16; t < 64; ++t)
         {
-            SHA2_InitializeContextSHA256(&context);
-            break;
+            W[t] = _mm256_add_epi32(_mm256_add_epi32(SHA2_AVX2_SSIG1_SHA256(W[t - 2]), W[t - 7]),
+                                    _mm256_add_epi32(SHA2_AVX2_SSIG0_SHA256(W[t - 15]), W[t - 16]));
         }
-        default:
+
+        __m256i A = H[0];
+        __m256i B = H[1];
+        __m256i C = H[2];
+        __m256i D = H[3];
+        __m256i E = H[4];
+        __m256i F = H[5];
+        __m256i G = H[6];
+        __m256i HH = H[7];
+
+        for (int t = 0; t < 64; ++t)
         {
-            sha2_assert(false);
+            __m256i T1 = _mm256_add_epi32(_mm256_add_epi32(HH, SHA2_AVX2_BSIG1_SHA256(E)),
+                                          _mm256_add_epi32(SHA2_AVX2_CH_SHA256(E, F, G),
+                                                           _mm256_add_epi32(_mm256_set1_epi32((int)K_SHA256[t]), W[t])));
+            __m256i T2 = _mm256_add_epi32(SHA2_AVX2_BSIG0_SHA256(A), SHA2_AVX2_MAJ_SHA256(A, B, C));
 
-            context.Error = true;
-            sprintf(context.ErrorStr, "Invalid digest length for SHA256: %i", digestLength);
-            sprintf(context.DigestStr, "");
-            return context;
+            HH = G;
+            G = F;
+            F = E;
+            E = _mm256_add_epi32(D, T1);
+            D = C;
+            C = B;
+            B = A;
+            A = _mm256_add_epi32(T1, T2);
         }
+
+        H[0] = _mm256_add_epi32(H[0], A);
+        H[1] = _mm256_add_epi32(H[1], B);
+        H[2] = _mm256_add_epi32(H[2], C);
+        H[3] = _mm256_add_epi32(H[3], D);
+        H[4] = _mm256_add_epi32(H[4], E);
+        H[5] = _mm256_add_epi32(H[5], F);
+        H[6] = _mm256_add_epi32(H[6], G);
+        H[7] = _mm256_add_epi32(H[7], HH);
     }
 
-    FILE *file = fopen(fileName, "rb");
-    if (!file)
+    for (int i = 0; i < 8; ++i)
     {
-        sha2_assert(false);
-
-        context.Error = true;
-        sprintf(context.ErrorStr, "Unable to open file");
-        sprintf(context.DigestStr, "");
-        return context;
+        _mm256_storeu_si256((__m256i *)state->H[i], _mm256_blendv_epi8(initialH[i], H[i], activeLanes));
     }
 
-    // Note (Aaron): Create a buffer that can hold two full message blocks as
-    // we will potentially use the extra space when applying padding later.
-    uint8_t buffer[SHA2_MESSAGE_BLOCK_SIZE_SHA256 * 2];
-    uint8_t *bufferPtr = buffer;
-    uint8_t bufferSizeBytes = SHA2_MESSAGE_BLOCK_SIZE_SHA256 * 2;
-    sha2_static_assert(UINT8_MAX > (SHA2_MESSAGE_BLOCK_SIZE_SHA256 * 2),
-                       "bufferSizeBytes cannot fit within a uint8_t");
+    for (int lane = 0; lane < 8; ++lane)
+    {
+        state->BlockPtrs[lane] = blockPtrs[lane];
+    }
 
-#if HASHUTIL_SLOW
-    // Note (Aaron): Packing the buffer's bits with 1s for debug purposes
-    SHA2_MemorySet(bufferPtr, 0xff, bufferSizeBytes);
-#endif
+    // Zero out W[] to prevent sensitive information being left in memory
+    if (!state->DisableScrubbing)
+    {
+        SHA2_SecureZero(W, sizeof(W));
+    }
+}
 
-    size_t readElementSize = sizeof(uint8_t);
-    size_t readBlockSize = sizeof(uint8_t) * SHA2_MESSAGE_BLOCK_SIZE_SHA256;
-    uint64_t blockBytesRead = 0;
+// Note (Aaron): vpternlogd evaluates any three input bitwise function in one instruction. The
+// immediates are the truth tables of XOR3 (0x96), CH (0xca) and MAJ (0xe8).
+#define SHA2_AVX512_XOR3(x, y, z) _mm512_ternarylogic_epi32((x), (y), (z), 0x96)
+#define SHA2_AVX512_CH_SHA256(x, y, z) _mm512_ternarylogic_epi32((x), (y), (z), 0xca)
+#define SHA2_AVX512_MAJ_SHA256(x, y, z) _mm512_ternarylogic_epi32((x), (y), (z), 0xe8)
 
-    // Note (Aaron): Sanity check
-    sha2_assert(readElementSize == 1);
+#define SHA2_AVX512_BSIG0_SHA256(x) \
+    SHA2_AVX512_XOR3(_mm512_ror_epi32((x), 2), _mm512_ror_epi32((x), 13), _mm512_ror_epi32((x), 22))
 
-    // Update hash using file contents until we run out of blocks of sufficient size
-    blockBytesRead = fread(buffer, readElementSize, readBlockSize, file);
-    while(blockBytesRead)
-    {
-        sha2_assert(blockBytesRead <= SHA2_MESSAGE_BLOCK_SIZE_SHA256);
-        uint64_t oldMessageLengthBits = context.MessageLengthBits;
+#define SHA2_AVX512_BSIG1_SHA256(x) \
+    SHA2_AVX512_XOR3(_mm512_ror_epi32((x), 6), _mm512_ror_epi32((x), 11), _mm512_ror_epi32((x), 25))
 
-        context.MessageLengthBits += (blockBytesRead * 8);
-        if (context.MessageLengthBits < oldMessageLengthBits)
-        {
-            sha2_assert(false);
+#define SHA2_AVX512_SSIG0_SHA256(x) \
+    SHA2_AVX512_XOR3(_mm512_ror_epi32((x), 7), _mm512_ror_epi32((x), 18), _mm512_srli_epi32((x), 3))
 
-            context.Error = true;
-            sprintf(context.ErrorStr, "Invalid file size: larger than 2^64-1 bits");
-            sprintf(context.DigestStr, "");
-            return context;
-        }
+#define SHA2_AVX512_SSIG1_SHA256(x) \
+    SHA2_AVX512_XOR3(_mm512_ror_epi32((x), 17), _mm512_ror_epi32((x), 19), _mm512_srli_epi32((x), 10))
 
-        // Process the message in blocks of 512 bits (64 bytes or sixteen 32-bit words)
-        if(blockBytesRead == SHA2_MESSAGE_BLOCK_SIZE_SHA256)
-        {
-            SHA2_UpdateHashSHA256(&context, bufferPtr, blockBytesRead);
-            blockBytesRead = fread(buffer, readElementSize, readBlockSize, file);
-            continue;
-        }
+// Transposes a 16x16 matrix of 32-bit words so that row 'i' holds word 'i' of every input row
+SHA2_TARGET("avx512f")
+static void SHA2_Transpose16x16AVX512(__m512i *rows)
+{
+    __m512i t[16];
+    __m512i u[16];
 
-        // Note (Aaron): If we ever read less bytes than SHA2_MESSAGE_LENGTH_BLOCK_SHA256,
-        // it is time to stop reading the file and apply padding.
-        break;
+    for (int i = 0; i < 16; i += 2)
+    {
+        t[i + 0] = _mm512_unpacklo_epi32(rows[i], rows[i + 1]);
+        t[i + 1] = _mm512_unpackhi_epi32(rows[i], rows[i + 1]);
     }
 
-    if (ferror(file))
+    // Each 128-bit chunk 'j' of u[4 * g + k] now holds word 4 * j + k of rows 4 * g to 4 * g + 3
+    for (int i = 0; i < 16; i += 4)
     {
-        fclose(file);
-        sha2_assert(false);
-
-        context.Error = true;
-        sprintf(context.ErrorStr, "Error reading file");
-        sprintf(context.DigestStr, "");
-        return context;
+        u[i + 0] = _mm512_unpacklo_epi64(t[i + 0], t[i + 2]);
+        u[i + 1] = _mm512_unpackhi_epi64(t[i + 0], t[i + 2]);
+        u[i + 2] = _mm512_unpacklo_epi64(t[i + 1], t[i + 3]);
+        u[i + 3] = _mm512_unpackhi_epi64(t[i + 1], t[i + 3]);
     }
 
-    fclose(file);
-
-    // Apply the final hash update with padding
-    sha2_message_padding_info messageInfo =
+    for (int k = 0; k < 4; ++k)
     {
-        messageInfo.BufferPtr = buffer,
-        messageInfo.BufferSizeBytes = bufferSizeBytes,
-        messageInfo.BlockSizeBytes = SHA2_MESSAGE_BLOCK_SIZE_SHA256,
-        messageInfo.MessageRemainderSizeBytes = blockBytesRead,
-        messageInfo.MessageLengthBlockSizeBytes = SHA2_MESSAGE_LENGTH_BLOCK_SHA256,
-        messageInfo.MessageLengthBitsHigh = 0,
-        messageInfo.MessageLengthBitsLow = context.MessageLengthBits,
-    };
+        __m512i low01 = _mm512_shuffle_i32x4(u[k + 0], u[k + 4], 0x44);
+        __m512i high01 = _mm512_shuffle_i32x4(u[k + 0], u[k + 4], 0xee);
+        __m512i low23 = _mm512_shuffle_i32x4(u[k + 8], u[k + 12], 0x44);
+        __m512i high23 = _mm512_shuffle_i32x4(u[k + 8], u[k + 12], 0xee);
+
+        rows[k + 0] = _mm512_shuffle_i32x4(low01, low23, 0x88);
+        rows[k + 4] = _mm512_shuffle_i32x4(low01, low23, 0xdd);
+        rows[k + 8] = _mm512_shuffle_i32x4(high01, high23, 0x88);
+        rows[k + 12] = _mm512_shuffle_i32x4(high01, high23, 0xdd);
+    }
+}
 
-    SHA2_ApplyPadding(messageInfo);
+SHA2_TARGET("avx512f,avx512bw")
+static void SHA2_UpdateHashSHA256x16AVX512(sha2_256_multi_buffer_state *state, uint32_t laneMask, uint64_t blockCount)
+{
+    sha2_assert(laneMask != 0);
+    sha2_assert(laneMask < (1 << 16));
 
-    // Apply final hash update and construct the digest
-    bool useFullBuffer = blockBytesRead > (SHA2_MESSAGE_BLOCK_SIZE_SHA256 - SHA2_MESSAGE_LENGTH_BLOCK_SHA256 - 1);
-    blockBytesRead = useFullBuffer ? (bufferSizeBytes) : SHA2_MESSAGE_BLOCK_SIZE_SHA256;
-    SHA2_UpdateHashSHA256(&context, buffer, blockBytesRead);
+    // Byte shuffle that converts each 32-bit word of the message to big endian
+    __m512i const byteSwapMask = _mm512_set_epi64(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL,
+                                                  0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL,
+                                                  0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL,
+                                                  0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
 
-    switch (digestLength)
+    __mmask16 const activeLanes = (__mmask16)laneMask;
+
+    uint8_t const *blockPtrs[16];
+    uint64_t blockStrides[16];
+    for (int lane = 0; lane < 16; ++lane)
     {
-        case SHA2_DIGEST_LENGTH_SHA224:
-        {
-            SHA2_ConstructDigestSHA224(&context);
-            break;
-        }
-        case SHA2_DIGEST_LENGTH_SHA256:
-        {
-            SHA2_ConstructDigestSHA256(&context);
-            break;
-        }
-        default:
-        {
-            // Invalid digest length for SHA256. We should never reach this state here.
-            sha2_assert(false);
-        }
+        blockPtrs[lane] = state->BlockPtrs[lane];
+        blockStrides[lane] = (laneMask & (1 << lane)) ? SHA2_MESSAGE_BLOCK_SIZE_SHA256 : 0;
     }
 
-    return context;
-}
+    __m512i H[8];
+    for (int i = 0; i < 8; ++i)
+    {
+        H[i] = _mm512_loadu_si512(state->H[i]);
+    }
 
-sha2_512_context SHA2_HashStringSHA512_(char *messagePtr, sha2_digest_length digestLength)
-{
-    sha2_512_context context;
-    uint16_t messageBlockByteCount = 0;
-    sha2_static_assert(UINT16_MAX > (SHA2_MESSAGE_BLOCK_SIZE_SHA512 * 2),
-                       "messageBlockByteCount cannot fit within a uint16_t");
+    __m512i W[64];
 
-    switch (digestLength)
+    for (uint64_t block = 0; block < blockCount; ++block)
     {
-        case SHA2_DIGEST_LENGTH_SHA224:
+        // Each lane's message block fills one register, transposing gives W[0..15] for every lane
+        for (int lane = 0; lane < 16; ++lane)
         {
-            SHA2_InitializeContextSHA512_224(&context);
-            break;
+            W[lane] = _mm512_loadu_si512(blockPtrs[lane]);
+            blockPtrs[lane] += blockStrides[lane];
         }
-        case SHA2_DIGEST_LENGTH_SHA256:
+
+        SHA2_Transpose16x16AVX512(W);
+
+        for (int t = 0; t < 16; ++t)
         {
-            SHA2_InitializeContextSHA512_256(&context);
-            break;
+            W[t] = _mm512_shuffle_epi8(W[t], byteSwapMask);
         }
-        case SHA2_DIGEST_LENGTH_SHA384:
+
+        for (int t = 16; t < 64; ++t)
         {
-            SHA2_InitializeContextSHA384(&context);
-            break;
+            W[t] = _mm512_add_epi32(_mm512_add_epi32(SHA2_AVX512_SSIG1_SHA256(W[t - 2]), W[t - 7]),
+                                    _mm512_add_epi32(SHA2_AVX512_SSIG0_SHA256(W[t - 15]), W[t - 16]));
         }
-        case SHA2_DIGEST_LENGTH_SHA512:
+
+        __m512i A = H[0];
+        __m512i B = H[1];
+        __m512i C = H[2];
+        __m512i D = H[3];
+        __m512i E = H[4];
+        __m512i F = H[5];
+        __m512i G = H[6];
+        __m512i HH = H[7];
+
+        for (int t = 0; t < 64; ++t)
         {
-            SHA2_InitializeContextSHA512(&context);
-            break;
+            __m512i T1 = _mm512_add_epi32(_mm512_add_epi32(HH, SHA2_AVX512_BSIG1_SHA256(E)),
+                                          _mm512_add_epi32(SHA2_AVX512_CH_SHA256(E, F, G),
+                                                           _mm512_add_epi32(_mm512_set1_epi32((int)K_SHA256[t]), W[t])));
+            __m512i T2 = _mm512_add_epi32(SHA2_AVX512_BSIG0_SHA256(A), SHA2_AVX512_MAJ_SHA256(A, B, C));
+
+            HH = G;
+            G = F;
+            F = E;
+            E = _mm512_add_epi32(D, T1);
+            D = C;
+            C = B;
+            B = A;
+            A = _mm512_add_epi32(T1, T2);
         }
-        default:
-        {
-            sha2_assert(false);
 
-            context.Error = true;
-            sprintf(context.ErrorStr, "Invalid digest length for SHA512: %i", digestLength);
-            sprintf(context.DigestStr, "");
+        H[0] = _mm512_add_epi32(H[0], A);
+        H[1] = _mm512_add_epi32(H[1], B);
+        H[2] = _mm512_add_epi32(H[2], C);
+        H[3] = _mm512_add_epi32(H[3], D);
+        H[4] = _mm512_add_epi32(H[4], E);
+        H[5] = _mm512_add_epi32(H[5], F);
+        H[6] = _mm512_add_epi32(H[6], G);
+        H[7] = _mm512_add_epi32(H[7], HH);
+    }
 
-            return context;
-        }
+    // Only active lanes are written back, idle lanes keep their state
+    for (int i = 0; i < 8; ++i)
+    {
+        _mm512_mask_storeu_epi32(state->H[i], activeLanes, H[i]);
     }
 
-    // Iterate over message until we can no longer fill a message block
-    while (*messagePtr != 0x00)
+    for (int lane = 0; lane < 16; ++lane)
     {
-        sha2_assert(messageBlockByteCount < SHA2_MESSAGE_BLOCK_SIZE_SHA512);
-        uint128_t oldMessageLengthBits =
-        {
-            oldMessageLengthBits.High = context.MessageLengthBits.High,
-            oldMessageLengthBits.Low = context.MessageLengthBits.Low,
-        };
+        state->BlockPtrs[lane] = blockPtrs[lane];
+    }
+
+    // Zero out W[] to prevent sensitive information being left in memory
+    if (!state->DisableScrubbing)
+    {
+        SHA2_SecureZero(W, sizeof(W));
+    }
+}
+#endif
+
+// One SHA512 round on scalar registers. Callers rotate the variable names instead of moving values.
+#define SHA2_ROUND_SHA512(a, b, c, d, e, f, g, h, wk) \
+    t1 = (h) + SHA2_BSIG1_SHA512(e) + SHA2_CH_SHA512((e), (f), (g)) + (wk); \
+    d += t1; \
+    h = t1 + SHA2_BSIG0_SHA512(a) + SHA2_MAJ_SHA512((a), (b), (c))
+
+// Returns W[t] for round 't' of a block. Words past the first 16 are computed in place of W[t - 16].
+#define SHA2_SCALAR_WORD_SHA512(t) \
+    ((t) < 16 ? W[(t) & 15] \
+              : (W[(t) & 15] += SHA2_SSIG1_SHA512(W[((t) - 2) & 15]) + W[((t) - 7) & 15] + SHA2_SSIG0_SHA512(W[((t) - 15) & 15])))
+
+// Eight rounds starting at round 't'. The names of A-H are back in their original order afterwards.
+#define SHA2_SCALAR_ROUNDS8_SHA512(t) \
+    SHA2_ROUND_SHA512(A, B, C, D, E, F, G, H, K_SHA512[(t) + 0] + SHA2_SCALAR_WORD_SHA512((t) + 0)); \
+    SHA2_ROUND_SHA512(H, A, B, C, D, E, F, G, K_SHA512[(t) + 1] + SHA2_SCALAR_WORD_SHA512((t) + 1)); \
+    SHA2_ROUND_SHA512(G, H, A, B, C, D, E, F, K_SHA512[(t) + 2] + SHA2_SCALAR_WORD_SHA512((t) + 2)); \
+    SHA2_ROUND_SHA512(F, G, H, A, B, C, D, E, K_SHA512[(t) + 3] + SHA2_SCALAR_WORD_SHA512((t) + 3)); \
+    SHA2_ROUND_SHA512(E, F, G, H, A, B, C, D, K_SHA512[(t) + 4] + SHA2_SCALAR_WORD_SHA512((t) + 4)); \
+    SHA2_ROUND_SHA512(D, E, F, G, H, A, B, C, K_SHA512[(t) + 5] + SHA2_SCALAR_WORD_SHA512((t) + 5)); \
+    SHA2_ROUND_SHA512(C, D, E, F, G, H, A, B, K_SHA512[(t) + 6] + SHA2_SCALAR_WORD_SHA512((t) + 6)); \
+    SHA2_ROUND_SHA512(B, C, D, E, F, G, H, A, K_SHA512[(t) + 7] + SHA2_SCALAR_WORD_SHA512((t) + 7))
+
+// Same as SHA2_DEFINE_SCALAR_KERNEL_SHA256 but for the 64-bit words and 80 rounds of SHA512
+#define SHA2_DEFINE_SCALAR_KERNEL_SHA512(kernelName, attributes) \
+attributes \
+static void kernelName(sha2_512_hash *state, uint8_t *messagePtr, uint64_t byteCount) \
+{ \
+    sha2_assert(byteCount % SHA2_MESSAGE_BLOCK_SIZE_SHA512 == 0); \
+ \
+    uint64_t W[16]; \
+    uint64_t t1; \
+ \
+    uint64_t A = state->H0; \
+    uint64_t B = state->H1; \
+    uint64_t C = state->H2; \
+    uint64_t D = state->H3; \
+    uint64_t E = state->H4; \
+    uint64_t F = state->H5; \
+    uint64_t G = state->H6; \
+    uint64_t H = state->H7; \
+ \
+    /* Iterate over blocks of the message */ \
+    /* 'i' holds the current block's byte position in the message */ \
+    for (uint64_t i = 0; i < byteCount; i += SHA2_MESSAGE_BLOCK_SIZE_SHA512) \
+    { \
+        /* 'j' holds the word position from the start of the current block being processed */ \
+        for (int j = 0; j < 16; ++j) \
+        { \
+            W[j] = SHA2_LoadBE64(messagePtr + i + (j * 8)); \
+        } \
+ \
+        SHA2_SCALAR_ROUNDS8_SHA512(0); \
+        SHA2_SCALAR_ROUNDS8_SHA512(8); \
+        SHA2_SCALAR_ROUNDS8_SHA512(16); \
+        SHA2_SCALAR_ROUNDS8_SHA512(24); \
+        SHA2_SCALAR_ROUNDS8_SHA512(32); \
+        SHA2_SCALAR_ROUNDS8_SHA512(40); \
+        SHA2_SCALAR_ROUNDS8_SHA512(48); \
+        SHA2_SCALAR_ROUNDS8_SHA512(56); \
+        SHA2_SCALAR_ROUNDS8_SHA512(64); \
+        SHA2_SCALAR_ROUNDS8_SHA512(72); \
+ \
+        A = (state->H0 += A); \
+        B = (state->H1 += B); \
+        C = (state->H2 += C); \
+        D = (state->H3 += D); \
+        E = (state->H4 += E); \
+        F = (state->H5 += F); \
+        G = (state->H6 += G); \
+        H = (state->H7 += H); \
+    } \
+ \
+    /* Zero out W[] to prevent sensitive information being left in memory */ \
+    if (!state->DisableScrubbing) \
+    { \
+        SHA2_SecureZero(W, sizeof(W)); \
+    } \
+}
+
+SHA2_DEFINE_SCALAR_KERNEL_SHA512(SHA2_UpdateHashSHA512Scalar, )
+
+#if SHA2_X64
+SHA2_DEFINE_SCALAR_KERNEL_SHA512(SHA2_UpdateHashSHA512BMI2, SHA2_TARGET("bmi,bmi2"))
+#endif
+
+#if SHA2_X64
+#define SHA2_ROUNDS4_SHA512(a, b, c, d, e, f, g, h, t) \
+    SHA2_ROUND_SHA512(a, b, c, d, e, f, g, h, WK[(t) + 0]); \
+    SHA2_ROUND_SHA512(h, a, b, c, d, e, f, g, WK[(t) + 1]); \
+    SHA2_ROUND_SHA512(g, h, a, b, c, d, e, f, WK[(t) + 2]); \
+    SHA2_ROUND_SHA512(f, g, h, a, b, c, d, e, WK[(t) + 3])
+
+#define SHA2_AVX2_ROTR64(x, count) \
+    _mm256_or_si256(_mm256_srli_epi64((x), (count)), _mm256_slli_epi64((x), 64 - (count)))
+
+#define SHA2_AVX2_XOR3(x, y, z) _mm256_xor_si256(_mm256_xor_si256((x), (y)), (z))
+
+// Computes W[t..t+3] into 'x0', which holds W[t-16..t-13] on entry, and stores W[t..t+3] + K[t..t+3].
+// W[t+2] and W[t+3] depend on W[t] and W[t+1], so SSIG1 is applied to the low and high halves in turn.
+// 'ROTR64' and 'XOR3' supply the instructions used for the sigma functions.
+#define SHA2_SIMD_SCHEDULE_SHA512(x0, x1, x2, x3, t, ROTR64, XOR3) \
+    shifted = _mm256_permute4x64_epi64(_mm256_blend_epi32((x0), (x1), 0x03), 0x39); \
+    schedule = _mm256_add_epi64((x0), XOR3(ROTR64(shifted, 1), ROTR64(shifted, 8), _mm256_srli_epi64(shifted, 7))); \
+    shifted = _mm256_permute4x64_epi64(_mm256_blend_epi32((x2), (x3), 0x03), 0x39); \
+    schedule = _mm256_add_epi64(schedule, shifted); \
+    shifted = _mm256_permute4x64_epi64((x3), 0xee); \
+    schedule = _mm256_add_epi64(schedule, _mm256_and_si256(XOR3(ROTR64(shifted, 19), ROTR64(shifted, 61), \
+                                                                _mm256_srli_epi64(shifted, 6)), lowHalf)); \
+    shifted = _mm256_permute4x64_epi64(schedule, 0x44); \
+    x0 = _mm256_add_epi64(schedule, _mm256_and_si256(XOR3(ROTR64(shifted, 19), ROTR64(shifted, 61), \
+                                                          _mm256_srli_epi64(shifted, 6)), highHalf)); \
+    _mm256_storeu_si256((__m256i *)&WK[(t)], _mm256_add_epi64((x0), _mm256_loadu_si256((__m256i const *)&K_SHA512[(t)])))
+
+// Note (Aaron): Kernel that loads and byte swaps the message with vpshufb and expands the message
+// schedule four words at a time in vector registers while the rounds run on scalar registers, so
+// the two can overlap. BMI2 lets the rounds' rotations use RORX.
+#define SHA2_DEFINE_SIMD_SCHEDULE_KERNEL_SHA512(kernelName, features, ROTR64, XOR3) \
+SHA2_TARGET(features) \
+static void kernelName(sha2_512_hash *state, uint8_t *messagePtr, uint64_t byteCount) \
+{ \
+    sha2_assert(byteCount % SHA2_MESSAGE_BLOCK_SIZE_SHA512 == 0); \
+ \
+    __m256i const byteSwapMask = _mm256_set_epi64x(0x08090a0b0c0d0e0fULL, 0x0001020304050607ULL, \
+                                                   0x08090a0b0c0d0e0fULL, 0x0001020304050607ULL); \
+    __m256i const lowHalf = _mm256_set_epi64x(0, 0, -1, -1); \
+    __m256i const highHalf = _mm256_set_epi64x(-1, -1, 0, 0); \
+ \
+    uint64_t WK[80]; \
+    uint64_t t1; \
+    __m256i schedule; \
+    __m256i shifted; \
+ \
+    uint64_t A = state->H0; \
+    uint64_t B = state->H1; \
+    uint64_t C = state->H2; \
+    uint64_t D = state->H3; \
+    uint64_t E = state->H4; \
+    uint64_t F = state->H5; \
+    uint64_t G = state->H6; \
+    uint64_t H = state->H7; \
+ \
+    for (uint64_t i = 0; i < byteCount; i += SHA2_MESSAGE_BLOCK_SIZE_SHA512) \
+    { \
+        __m256i x0 = _mm256_shuffle_epi8(_mm256_loadu_si256((__m256i const *)(messagePtr + i + 0)), byteSwapMask); \
+        __m256i x1 = _mm256_shuffle_epi8(_mm256_loadu_si256((__m256i const *)(messagePtr + i + 32)), byteSwapMask); \
+        __m256i x2 = _mm256_shuffle_epi8(_mm256_loadu_si256((__m256i const *)(messagePtr + i + 64)), byteSwapMask); \
+        __m256i x3 = _mm256_shuffle_epi8(_mm256_loadu_si256((__m256i const *)(messagePtr + i + 96)), byteSwapMask); \
+ \
+        _mm256_storeu_si256((__m256i *)&WK[0], _mm256_add_epi64(x0, _mm256_loadu_si256((__m256i const *)&K_SHA512[0]))); \
+        _mm256_storeu_si256((__m256i *)&WK[4], _mm256_add_epi64(x1, _mm256_loadu_si256((__m256i const *)&K_SHA512[4]))); \
+        _mm256_storeu_si256((__m256i *)&WK[8], _mm256_add_epi64(x2, _mm256_loadu_si256((__m256i const *)&K_SHA512[8]))); \
+        _mm256_storeu_si256((__m256i *)&WK[12], _mm256_add_epi64(x3, _mm256_loadu_si256((__m256i const *)&K_SHA512[12]))); \
+ \
+        /* Rounds 0-63 each run alongside the expansion of the schedule words 16 rounds ahead */ \
+        for (int t = 0; t < 64; t += 16) \
+        { \
+            SHA2_SIMD_SCHEDULE_SHA512(x0, x1, x2, x3, t + 16, ROTR64, XOR3); \
+            SHA2_ROUNDS4_SHA512(A, B, C, D, E, F, G, H, t + 0); \
+            SHA2_SIMD_SCHEDULE_SHA512(x1, x2, x3, x0, t + 20, ROTR64, XOR3); \
+            SHA2_ROUNDS4_SHA512(E, F, G, H, A, B, C, D, t + 4); \
+            SHA2_SIMD_SCHEDULE_SHA512(x2, x3, x0, x1, t + 24, ROTR64, XOR3); \
+            SHA2_ROUNDS4_SHA512(A, B, C, D, E, F, G, H, t + 8); \
+            SHA2_SIMD_SCHEDULE_SHA512(x3, x0, x1, x2, t + 28, ROTR64, XOR3); \
+            SHA2_ROUNDS4_SHA512(E, F, G, H, A, B, C, D, t + 12); \
+        } \
+ \
+        SHA2_ROUNDS4_SHA512(A, B, C, D, E, F, G, H, 64); \
+        SHA2_ROUNDS4_SHA512(E, F, G, H, A, B, C, D, 68); \
+        SHA2_ROUNDS4_SHA512(A, B, C, D, E, F, G, H, 72); \
+        SHA2_ROUNDS4_SHA512(E, F, G, H, A, B, C, D, 76); \
+ \
+        A = (state->H0 += A); \
+        B = (state->H1 += B); \
+        C = (state->H2 += C); \
+        D = (state->H3 += D); \
+        E = (state->H4 += E); \
+        F = (state->H5 += F); \
+        G = (state->H6 += G); \
+        H = (state->H7 += H); \
+    } \
+ \
+    /* Zero out WK[] to prevent sensitive information being left in memory */ \
+    if (!state->DisableScrubbing) \
+    { \
+        SHA2_SecureZero(WK, sizeof(WK)); \
+    } \
+}
+
+#define SHA2_AVX512VL_ROTR64(x, count) _mm256_ror_epi64((x), (count))
+#define SHA2_AVX512VL_XOR3_64(x, y, z) _mm256_ternarylogic_epi64((x), (y), (z), 0x96)
+
+SHA2_DEFINE_SIMD_SCHEDULE_KERNEL_SHA512(SHA2_UpdateHashSHA512AVX2, "avx2,bmi2", SHA2_AVX2_ROTR64, SHA2_AVX2_XOR3)
+
+// Note (Aaron): The AVX-512 kernel folds each sigma function's rotations into VPRORQ and its XORs into a
+// single VPTERNLOGQ on 256-bit registers. The rounds stay on scalar registers: one stream's rounds are a
+// serial dependency chain and RORX has lower latency than a round trip through vector registers.
+SHA2_DEFINE_SIMD_SCHEDULE_KERNEL_SHA512(SHA2_UpdateHashSHA512AVX512, "avx512f,avx512vl,avx2,bmi2", SHA2_AVX512VL_ROTR64, SHA2_AVX512VL_XOR3_64)
+#endif
+
+typedef void sha2_512_kernel(sha2_512_hash *state, uint8_t *messagePtr, uint64_t byteCount);
+
+typedef struct
+{
+    char const *Name;
+    uint32_t RequiredFeatures;
+    sha2_512_kernel *Kernel;
+} sha2_512_kernel_info;
+
+// Note (Aaron): Kernels in order of preference. The first kernel the CPU supports is used unless
+// HASHUTIL_FORCE_KERNEL names another supported kernel.
+static sha2_512_kernel_info const SHA2_KernelsSHA512[] =
+{
+#if SHA2_X64
+    { "avx512", SHA2_CPU_FEATURE_AVX512F | SHA2_CPU_FEATURE_AVX512VL | SHA2_CPU_FEATURE_AVX2 | SHA2_CPU_FEATURE_BMI2, SHA2_UpdateHashSHA512AVX512 },
+    { "avx2", SHA2_CPU_FEATURE_AVX2 | SHA2_CPU_FEATURE_BMI2, SHA2_UpdateHashSHA512AVX2 },
+    { "bmi2", SHA2_CPU_FEATURE_BMI1 | SHA2_CPU_FEATURE_BMI2, SHA2_UpdateHashSHA512BMI2 },
+#endif
+    { "scalar", 0, SHA2_UpdateHashSHA512Scalar },
+};
 
-        messagePtr++;
-        messageBlockByteCount++;
-        SHA2_IncrementUINT128(&context.MessageLengthBits, 8);
-        if (SHA2_UINT128GreaterThan(oldMessageLengthBits, context.MessageLengthBits))
-        {
-            sha2_assert(false);
 
-            context.Error = true;
-            sprintf(context.ErrorStr, "Invalid message length: larger than 2^128-1 bits");
-            sprintf(context.DigestStr, "");
-            return context;
+// Picks the kernel named 'forcedName' if the CPU supports it, otherwise the preferred kernel
+static sha2_512_kernel_info const *SHA2_SelectKernelSHA512(char const *forcedName)
+{
+    if (forcedName)
+    {
+        for (size_t i = 0; i < SHA2_ArrayCount(SHA2_KernelsSHA512); ++i)
+        {
+            if ((strcmp(SHA2_KernelsSHA512[i].Name, forcedName) == 0) && SHA2_IsKernelSupported(SHA2_KernelsSHA512[i].RequiredFeatures))
+            {
+                return &SHA2_KernelsSHA512[i];
+            }
         }
+    }
 
-        // Process the message in blocks of 1024 bits (128 bytes or sixteen 64-bit words)
-        if (messageBlockByteCount == SHA2_MESSAGE_BLOCK_SIZE_SHA512)
+    for (size_t i = 0; i < SHA2_ArrayCount(SHA2_KernelsSHA512); ++i)
+    {
+        if (SHA2_IsKernelSupported(SHA2_KernelsSHA512[i].RequiredFeatures))
         {
-            SHA2_UpdateHashSHA512(&context, (uint8_t *)messagePtr - messageBlockByteCount, messageBlockByteCount);
-            messageBlockByteCount = 0;
+            return &SHA2_KernelsSHA512[i];
         }
     }
 
-    // Allocate a buffer to store the final message block
-    // Note (Aaron): We use a double sized buffer to cover the worst case scenario
-    // where the message remainder + padding + message length cannot fit into one
-    // message block.
-    uint8_t buffer[SHA2_MESSAGE_BLOCK_SIZE_SHA512 * 2];
-    uint16_t bufferSizeBytes = SHA2_MESSAGE_BLOCK_SIZE_SHA512 * 2;
-    sha2_static_assert(UINT16_MAX > (SHA2_MESSAGE_BLOCK_SIZE_SHA512 * 2),
-                       "bufferSizeBytes cannot fit within a uint16_t");
+    sha2_assert(false);
+    return &SHA2_KernelsSHA512[SHA2_ArrayCount(SHA2_KernelsSHA512) - 1];
+}
 
-#if HASHUTIL_SLOW
-    // Note (Aaron): Packing the buffer's bits with 1s for debug purposes
-    SHA2_MemorySet(buffer, 0xff, bufferSizeBytes);
-#endif
 
-    // Copy message remainder (if any) into buffer
-    if (messageBlockByteCount > 0)
+static sha2_512_kernel_info const *SHA2_GetKernelInfoSHA512()
+{
+    // Note (Aaron): The kernel is only selected once. Racing threads select the same kernel, and
+    // the cache is a single pointer that is loaded and stored atomically.
+    static void const *selectedKernel = 0;
+
+    sha2_512_kernel_info const *kernel = (sha2_512_kernel_info const *)SHA2_AtomicLoadPointer(&selectedKernel);
+    if (!kernel)
     {
-        SHA2_MemoryCopy(buffer, (uint8_t *)(messagePtr - messageBlockByteCount), messageBlockByteCount);
+        kernel = SHA2_SelectKernelSHA512(SHA2_GetForcedKernelName());
+        SHA2_AtomicStorePointer(&selectedKernel, kernel);
     }
 
-    // Apply padding to the final message blocks(s)
-    sha2_message_padding_info messageInfo =
-    {
-        messageInfo.BufferPtr = buffer,
-        messageInfo.BufferSizeBytes = bufferSizeBytes,
-        messageInfo.BlockSizeBytes = SHA2_MESSAGE_BLOCK_SIZE_SHA512,
-        messageInfo.MessageRemainderSizeBytes = messageBlockByteCount,
-        messageInfo.MessageLengthBlockSizeBytes = SHA2_MESSAGE_LENGTH_BLOCK_SHA512,
-        messageInfo.MessageLengthBitsHigh = context.MessageLengthBits.High,
-        messageInfo.MessageLengthBitsLow = context.MessageLengthBits.Low,
-    };
+    return kernel;
+}
 
-    SHA2_ApplyPadding(messageInfo);
 
-    // Apply final hash update and construct the digest
-    bool useFullBuffer = messageBlockByteCount > (SHA2_MESSAGE_BLOCK_SIZE_SHA512 - SHA2_MESSAGE_LENGTH_BLOCK_SHA512 - 1);
-    messageBlockByteCount = useFullBuffer ? (bufferSizeBytes) : SHA2_MESSAGE_BLOCK_SIZE_SHA512;
-    SHA2_UpdateHashSHA512(&context, (uint8_t *)buffer, messageBlockByteCount);
+#if SHA2_USE_IFUNC
+// Picks the SHA2_UpdateHashSHA512() kernel when the dynamic loader relocates the module
+static sha2_512_kernel *SHA2_ResolveUpdateHashSHA512()
+{
+    return SHA2_GetKernelInfoSHA512()->Kernel;
+}
 
-    switch (digestLength)
-    {
-        case SHA2_DIGEST_LENGTH_SHA224:
-        {
-            SHA2_ConstructDigestSHA512_224(&context);
-            break;
-        }
-        case SHA2_DIGEST_LENGTH_SHA256:
-        {
-            SHA2_ConstructDigestSHA512_256(&context);
-            break;
-        }
-        case SHA2_DIGEST_LENGTH_SHA384:
-        {
-            SHA2_ConstructDigestSHA384(&context);
-            break;
-        }
-        case SHA2_DIGEST_LENGTH_SHA512:
-        {
-            SHA2_ConstructDigestSHA512(&context);
-            break;
-        }
-        default:
-        {
-            // Invalid digest length for SHA512. We should never reach this state here.
-            sha2_assert(false);
-        }
-    }
+static void SHA2_UpdateHashSHA512(sha2_512_hash *state, uint8_t *messagePtr, uint64_t byteCount) __attribute__((ifunc("SHA2_ResolveUpdateHashSHA512")));
+#else
+static void SHA2_UpdateHashSHA512(sha2_512_hash *state, uint8_t *messagePtr, uint64_t byteCount)
+{
+    SHA2_GetKernelInfoSHA512()->Kernel(state, messagePtr, byteCount);
+}
+#endif
 
-    return context;
+
+char const *SHA2_GetKernelNameSHA512()
+{
+    return SHA2_GetKernelInfoSHA512()->Name;
 }
 
-sha2_512_context SHA2_HashFileSHA512_(char *fileName, sha2_digest_length digestLength)
+typedef struct
 {
-    sha2_512_context context;
-    switch (digestLength)
+    uint64_t H[8][SHA2_MULTI_BUFFER_MAX_LANES];
+    uint8_t const *BlockPtrs[SHA2_MULTI_BUFFER_MAX_LANES];
+    bool DisableScrubbing;
+} sha2_512_multi_buffer_state;
+
+// Hashes 'blockCount' message blocks for every lane set in 'laneMask'. Lanes not set in the mask
+// must point at a readable message block and keep their state and block pointer unchanged.
+typedef void sha2_512_multi_buffer_kernel(sha2_512_multi_buffer_state *state, uint32_t laneMask, uint64_t blockCount);
+
+#if SHA2_X64
+#define SHA2_AVX2_BSIG0_SHA512(x) \
+    _mm256_xor_si256(_mm256_xor_si256(SHA2_AVX2_ROTR64((x), 28), SHA2_AVX2_ROTR64((x), 34)), SHA2_AVX2_ROTR64((x), 39))
+
+#define SHA2_AVX2_BSIG1_SHA512(x) \
+    _mm256_xor_si256(_mm256_xor_si256(SHA2_AVX2_ROTR64((x), 14), SHA2_AVX2_ROTR64((x), 18)), SHA2_AVX2_ROTR64((x), 41))
+
+#define SHA2_AVX2_SSIG0_SHA512(x) \
+    _mm256_xor_si256(_mm256_xor_si256(SHA2_AVX2_ROTR64((x), 1), SHA2_AVX2_ROTR64((x), 8)), _mm256_srli_epi64((x), 7))
+
+#define SHA2_AVX2_SSIG1_SHA512(x) \
+    _mm256_xor_si256(_mm256_xor_si256(SHA2_AVX2_ROTR64((x), 19), SHA2_AVX2_ROTR64((x), 61)), _mm256_srli_epi64((x), 6))
+
+// Note (Aaron): CH and MAJ are plain bitwise functions so the SHA256 versions work on 64-bit lanes
+#define SHA2_AVX2_CH_SHA512(x, y, z) SHA2_AVX2_CH_SHA256((x), (y), (z))
+#define SHA2_AVX2_MAJ_SHA512(x, y, z) SHA2_AVX2_MAJ_SHA256((x), (y), (z))
+
+// Transposes a 4x4 matrix of 64-bit words so that row 'i' holds word 'i' of every input row
+SHA2_TARGET("avx2")
+static void SHA2_Transpose4x4AVX2(__m256i *rows)
+{
+    __m256i t0 = _mm256_unpacklo_epi64(rows[0], rows[1]);
+    __m256i t1 = _mm256_unpackhi_epi64(rows[0], rows[1]);
+    __m256i t2 = _mm256_unpacklo_epi64(rows[2], rows[3]);
+    __m256i t3 = _mm256_unpackhi_epi64(rows[2], rows[3]);
+
+    rows[0] = _mm256_permute2x128_si256(t0, t2, 0x20);
+    rows[1] = _mm256_permute2x128_si256(t1, t3, 0x20);
+    rows[2] = _mm256_permute2x128_si256(t0, t2, 0x31);
+    rows[3] = _mm256_permute2x128_si256(t1, t3, 0x31);
+}
+
+SHA2_TARGET("avx2")
+static void SHA2_UpdateHashSHA512x4AVX2(sha2_512_multi_buffer_state *state, uint32_t laneMask, uint64_t blockCount)
+{
+    sha2_assert(laneMask != 0);
+    sha2_assert(laneMask < (1 << 4));
+
+    // Byte shuffle that converts each 64-bit word of the message to big endian
+    __m256i const byteSwapMask = _mm256_set_epi64x(0x08090a0b0c0d0e0fULL, 0x0001020304050607ULL,
+                                                   0x08090a0b0c0d0e0fULL, 0x0001020304050607ULL);
+
+    // Expand the lane mask into a vector mask used to discard results for idle lanes
+    __m256i const laneBits = _mm256_setr_epi64x(1 << 0, 1 << 1, 1 << 2, 1 << 3);
+    __m256i const activeLanes = _mm256_cmpeq_epi64(_mm256_and_si256(_mm256_set1_epi64x(laneMask), laneBits), laneBits);
+
+    uint8_t const *blockPtrs[4];
+    uint64_t blockStrides[4];
+    for (int lane = 0; lane < 4; ++lane)
     {
-        case SHA2_DIGEST_LENGTH_SHA224:
+        blockPtrs[lane] = state->BlockPtrs[lane];
+        blockStrides[lane] = (laneMask & (1 << lane)) ? SHA2_MESSAGE_BLOCK_SIZE_SHA512 : 0;
+    }
+
+    __m256i initialH[8];
+    __m256i H[8];
+    for (int i = 0; i < 8; ++i)
+    {
+        initialH[i] = _mm256_loadu_si256((__m256i const *)state->H[i]);
+        H[i] = initialH[i];
+    }
+
+    __m256i W[80];
+
+    for (uint64_t block = 0; block < blockCount; ++block)
+    {
+        // Load each lane's block a quarter at a time and transpose the quarters into W[0..15]
+        for (int quarter = 0; quarter < 4; ++quarter)
         {
-            SHA2_InitializeContextSHA512_224(&context);
-            break;
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                W[quarter * 4 + lane] = _mm256_loadu_si256((__m256i const *)(blockPtrs[lane] + quarter * 32));
+            }
+
+            SHA2_Transpose4x4AVX2(W + quarter * 4);
         }
-        case SHA2_DIGEST_LENGTH_SHA256:
+
+        for (int lane = 0; lane < 4; ++lane)
         {
-            SHA2_InitializeContextSHA512_256(&context);
-            break;
+            blockPtrs[lane] += blockStrides[lane];
         }
-        case SHA2_DIGEST_LENGTH_SHA384:
+
+        for (int t = 0; t < 16; ++t)
         {
-            SHA2_InitializeContextSHA384(&context);
-            break;
+            W[t] = _mm256_shuffle_epi8(W[t], byteSwapMask);
         }
-        case SHA2_DIGEST_LENGTH_SHA512:
+
+        for (int t = 16; t < 80; ++t)
         {
-            SHA2_InitializeContextSHA512(&context);
-            break;
+            W[t] = _mm256_add_epi64(_mm256_add_epi64(SHA2_AVX2_SSIG1_SHA512(W[t - 2]), W[t - 7]),
+                                    _mm256_add_epi64(SHA2_AVX2_SSIG0_SHA512(W[t - 15]), W[t - 16]));
         }
-        default:
+
+        __m256i A = H[0];
+        __m256i B = H[1];
+        __m256i C = H[2];
+        __m256i D = H[3];
+        __m256i E = H[4];
+        __m256i F = H[5];
+        __m256i G = H[6];
+        __m256i HH = H[7];
+
+        for (int t = 0; t < 80; ++t)
         {
-            sha2_assert(false);
+            __m256i T1 = _mm256_add_epi64(_mm256_add_epi64(HH, SHA2_AVX2_BSIG1_SHA512(E)),
+                                          _mm256_add_epi64(SHA2_AVX2_CH_SHA512(E, F, G),
+                                                           _mm256_add_epi64(_mm256_set1_epi64x((int64_t)K_SHA512[t]), W[t])));
+            __m256i T2 = _mm256_add_epi64(SHA2_AVX2_BSIG0_SHA512(A), SHA2_AVX2_MAJ_SHA512(A, B, C));
 
-            context.Error = true;
-            sprintf(context.ErrorStr, "Invalid digest length for SHA512: %i", digestLength);
-            sprintf(context.DigestStr, "");
-            return context;
+            HH = G;
+            G = F;
+            F = E;
+            E = _mm256_add_epi64(D, T1);
+            D = C;
+            C = B;
+            B = A;
+            A = _mm256_add_epi64(T1, T2);
         }
+
+        H[0] = _mm256_add_epi64(H[0], A);
+        H[1] = _mm256_add_epi64(H[1], B);
+        H[2] = _mm256_add_epi64(H[2], C);
+        H[3] = _mm256_add_epi64(H[3], D);
+        H[4] = _mm256_add_epi64(H[4], E);
+        H[5] = _mm256_add_epi64(H[5], F);
+        H[6] = _mm256_add_epi64(H[6], G);
+        H[7] = _mm256_add_epi64(H[7], HH);
     }
 
-    FILE *file = fopen(fileName, "rb");
-    if (!file)
+    for (int i = 0; i < 8; ++i)
     {
-        sha2_assert(false);
-
-        context.Error = true;
-        sprintf(context.ErrorStr, "Unable to open file");
-        sprintf(context.DigestStr, "");
-        return context;
+        _mm256_storeu_si256((__m256i *)state->H[i], _mm256_blendv_epi8(initialH[i], H[i], activeLanes));
     }
 
-    // Note (Aaron): Create a buffer that can hold two full message blocks as
-    // we will potentially use the extra space when applying padding later.
-    uint8_t buffer[SHA2_MESSAGE_BLOCK_SIZE_SHA512 * 2];
-    uint8_t *bufferPtr = buffer;
-    uint16_t bufferSizeBytes = SHA2_MESSAGE_BLOCK_SIZE_SHA512 * 2;
-    sha2_static_assert(UINT16_MAX > (SHA2_MESSAGE_BLOCK_SIZE_SHA512 * 2),
-                       "bufferSizeBytes cannot fit within a uint16_t");
+    for (int lane = 0; lane < 4; ++lane)
+    {
+        state->BlockPtrs[lane] = blockPtrs[lane];
+    }
 
-#if HASHUTIL_SLOW
-    // Note (Aaron): Packing the buffer's bits with 1s for debug purposes
-    SHA2_MemorySet(bufferPtr, 0xff, bufferSizeBytes);
-#endif
+    // Zero out W[] to prevent sensitive information being left in memory
+    if (!state->DisableScrubbing)
+    {
+        SHA2_SecureZero(W, sizeof(W));
+    }
+}
 
-    size_t readElementSize = sizeof(uint8_t);
-    size_t readBlockSize = sizeof(uint8_t) * SHA2_MESSAGE_BLOCK_SIZE_SHA512;
-    size_t blockBytesRead = 0;
+#define SHA2_AVX512_CH_SHA512(x, y, z) _mm512_ternarylogic_epi64((x), (y), (z), 0xca)
+#define SHA2_AVX512_MAJ_SHA512(x, y, z) _mm512_ternarylogic_epi64((x), (y), (z), 0xe8)
+#define SHA2_AVX512_XOR3_64(x, y, z) _mm512_ternarylogic_epi64((x), (y), (z), 0x96)
 
-    // Note (Aaron): Sanity check
-    sha2_assert(readElementSize == 1);
+#define SHA2_AVX512_BSIG0_SHA512(x) \
+    SHA2_AVX512_XOR3_64(_mm512_ror_epi64((x), 28), _mm512_ror_epi64((x), 34), _mm512_ror_epi64((x), 39))
 
-    // Update hash using file contents until we run out of blocks of sufficient size
-    blockBytesRead = fread(buffer, readElementSize, readBlockSize, file);
-    while(blockBytesRead)
-    {
-        sha2_assert(blockBytesRead <= SHA2_MESSAGE_BLOCK_SIZE_SHA512);
-        uint128_t oldMessageLengthBits =
-        {
-            oldMessageLengthBits.High = context.MessageLengthBits.High,
-            oldMessageLengthBits.Low = context.MessageLengthBits.Low,
-        };
+#define SHA2_AVX512_BSIG1_SHA512(x) \
+    SHA2_AVX512_XOR3_64(_mm512_ror_epi64((x), 14), _mm512_ror_epi64((x), 18), _mm512_ror_epi64((x), 41))
 
-        SHA2_IncrementUINT128(&context.MessageLengthBits, (blockBytesRead * 8));
-        if (SHA2_UINT128GreaterThan(oldMessageLengthBits, context.MessageLengthBits))
-        {
-            sha2_assert(false);
+#define SHA2_AVX512_SSIG0_SHA512(x) \
+    SHA2_AVX512_XOR3_64(_mm512_ror_epi64((x), 1), _mm512_ror_epi64((x), 8), _mm512_srli_epi64((x), 7))
 
-            context.Error = true;
-            sprintf(context.ErrorStr, "Invalid message length: larger than 2^128-1 bits");
-            sprintf(context.DigestStr, "");
-            return context;
-        }
+#define SHA2_AVX512_SSIG1_SHA512(x) \
+    SHA2_AVX512_XOR3_64(_mm512_ror_epi64((x), 19), _mm512_ror_epi64((x), 61), _mm512_srli_epi64((x), 6))
 
-        // Process the message in blocks of 1024 bits (128 bytes or sixteen 64-bit words)
-        if(blockBytesRead == SHA2_MESSAGE_BLOCK_SIZE_SHA512)
-        {
-            SHA2_UpdateHashSHA512(&context, bufferPtr, blockBytesRead);
-            blockBytesRead = fread(buffer, readElementSize, readBlockSize, file);
-            continue;
-        }
+// Transposes an 8x8 matrix of 64-bit words so that row 'i' holds word 'i' of every input row
+SHA2_TARGET("avx512f")
+static void SHA2_Transpose8x8AVX512(__m512i *rows)
+{
+    __m512i t[8];
 
-        // Note (Aaron): If we ever read less bytes than SHA2_MESSAGE_LENGTH_BLOCK_SHA512,
-        // it is time to stop reading the file and apply padding.
-        break;
+    // Each 128-bit chunk 'j' of t[2 * p + k] now holds word 2 * j + k of rows 2 * p and 2 * p + 1
+    for (int i = 0; i < 8; i += 2)
+    {
+        t[i + 0] = _mm512_unpacklo_epi64(rows[i], rows[i + 1]);
+        t[i + 1] = _mm512_unpackhi_epi64(rows[i], rows[i + 1]);
     }
 
-    if (ferror(file))
+    for (int k = 0; k < 2; ++k)
     {
-        fclose(file);
-        sha2_assert(false);
-
-        context.Error = true;
-        sprintf(context.ErrorStr, "Error reading file");
-        sprintf(context.DigestStr, "");
-        return context;
+        __m512i low01 = _mm512_shuffle_i64x2(t[k + 0], t[k + 2], 0x44);
+        __m512i high01 = _mm512_shuffle_i64x2(t[k + 0], t[k + 2], 0xee);
+        __m512i low23 = _mm512_shuffle_i64x2(t[k + 4], t[k + 6], 0x44);
+        __m512i high23 = _mm512_shuffle_i64x2(t[k + 4], t[k + 6], 0xee);
+
+        rows[k + 0] = _mm512_shuffle_i64x2(low01, low23, 0x88);
+        rows[k + 2] = _mm512_shuffle_i64x2(low01, low23, 0xdd);
+        rows[k + 4] = _mm512_shuffle_i64x2(high01, high23, 0x88);
+        rows[k + 6] = _mm512_shuffle_i64x2(high01, high23, 0xdd);
     }
+}
 
-    fclose(file);
+SHA2_TARGET("avx512f,avx512bw")
+static void SHA2_UpdateHashSHA512x8AVX512(sha2_512_multi_buffer_state *state, uint32_t laneMask, uint64_t blockCount)
+{
+    sha2_assert(laneMask != 0);
+    sha2_assert(laneMask < (1 << 8));
 
-    // Apply padding to the final message blocks(s)
-    sha2_message_padding_info messageInfo =
+    // Byte shuffle that converts each 64-bit word of the message to big endian
+    __m512i const byteSwapMask = _mm512_set_epi64(0x08090a0b0c0d0e0fULL, 0x0001020304050607ULL,
+                                                  0x08090a0b0c0d0e0fULL, 0x0001020304050607ULL,
+                                                  0x08090a0b0c0d0e0fULL, 0x0001020304050607ULL,
+                                                  0x08090a0b0c0d0e0fULL, 0x0001020304050607ULL);
+
+    __mmask8 const activeLanes = (__mmask8)laneMask;
+
+    uint8_t const *blockPtrs[8];
+    uint64_t blockStrides[8];
+    for (int lane = 0; lane < 8; ++lane)
     {
-        messageInfo.BufferPtr = buffer,
-        messageInfo.BufferSizeBytes = bufferSizeBytes,
-        messageInfo.BlockSizeBytes = SHA2_MESSAGE_BLOCK_SIZE_SHA512,
-        messageInfo.MessageRemainderSizeBytes = blockBytesRead,
-        messageInfo.MessageLengthBlockSizeBytes = SHA2_MESSAGE_LENGTH_BLOCK_SHA512,
-        messageInfo.MessageLengthBitsHigh = context.MessageLengthBits.High,
-        messageInfo.MessageLengthBitsLow = context.MessageLengthBits.Low,
-    };
+        blockPtrs[lane] = state->BlockPtrs[lane];
+        blockStrides[lane] = (laneMask & (1 << lane)) ? SHA2_MESSAGE_BLOCK_SIZE_SHA512 : 0;
+    }
 
-    SHA2_ApplyPadding(messageInfo);
+    __m512i H[8];
+    for (int i = 0; i < 8; ++i)
+    {
+        H[i] = _mm512_loadu_si512(state->H[i]);
+    }
 
-    // Apply final hash update and construct the digest
-    bool useFullBuffer = blockBytesRead > (SHA2_MESSAGE_BLOCK_SIZE_SHA512 - SHA2_MESSAGE_LENGTH_BLOCK_SHA512 - 1);
-    blockBytesRead = useFullBuffer ? (bufferSizeBytes) : SHA2_MESSAGE_BLOCK_SIZE_SHA512;
-    SHA2_UpdateHashSHA512(&context, buffer, blockBytesRead);
+    __m512i W[80];
 
-    switch (digestLength)
+    for (uint64_t block = 0; block < blockCount; ++block)
     {
-        case SHA2_DIGEST_LENGTH_SHA224:
-        {
-            SHA2_ConstructDigestSHA512_224(&context);
-            break;
-        }
-        case SHA2_DIGEST_LENGTH_SHA256:
+        // Each lane's message block fills two registers, transposing gives W[0..15] for every lane
+        for (int lane = 0; lane < 8; ++lane)
         {
-            SHA2_ConstructDigestSHA512_256(&context);
-            break;
+            W[lane] = _mm512_loadu_si512(blockPtrs[lane] + 0);
+            W[lane + 8] = _mm512_loadu_si512(blockPtrs[lane] + 64);
+            blockPtrs[lane] += blockStrides[lane];
         }
-        case SHA2_DIGEST_LENGTH_SHA384:
+
+        SHA2_Transpose8x8AVX512(W + 0);
+        SHA2_Transpose8x8AVX512(W + 8);
+
+        for (int t = 0; t < 16; ++t)
         {
-            SHA2_ConstructDigestSHA384(&context);
-            break;
+            W[t] = _mm512_shuffle_epi8(W[t], byteSwapMask);
         }
-        case SHA2_DIGEST_LENGTH_SHA512:
+
+        for (int t = 16; t < 80; ++t)
         {
-            SHA2_ConstructDigestSHA512(&context);
-            break;
+            W[t] = _mm512_add_epi64(_mm512_add_epi64(SHA2_AVX512_SSIG1_SHA512(W[t - 2]), W[t - 7]),
+                                    _mm512_add_epi64(SHA2_AVX512_SSIG0_SHA512(W[t - 15]), W[t - 16]));
         }
-        default:
+
+        __m512i A = H[0];
+        __m512i B = H[1];
+        __m512i C = H[2];
+        __m512i D = H[3];
+        __m512i E = H[4];
+        __m512i F = H[5];
+        __m512i G = H[6];
+        __m512i HH = H[7];
+
+        for (int t = 0; t < 80; ++t)
         {
-            // Invalid digest length for SHA512. We should never reach this state here.
-            sha2_assert(false);
+            __m512i T1 = _mm512_add_epi64(_mm512_add_epi64(HH, SHA2_AVX512_BSIG1_SHA512(E)),
+                                          _mm512_add_epi64(SHA2_AVX512_CH_SHA512(E, F, G),
+                                                           _mm512_add_epi64(_mm512_set1_epi64((int64_t)K_SHA512[t]), W[t])));
+            __m512i T2 = _mm512_add_epi64(SHA2_AVX512_BSIG0_SHA512(A), SHA2_AVX512_MAJ_SHA512(A, B, C));
+
+            HH = G;
+            G = F;
+            F = E;
+            E = _mm512_add_epi64(D, T1);
+            D = C;
+            C = B;
+            B = A;
+            A = _mm512_add_epi64(T1, T2);
         }
+
+        H[0] = _mm512_add_epi64(H[0], A);
+        H[1] = _mm512_add_epi64(H[1], B);
+        H[2] = _mm512_add_epi64(H[2], C);
+        H[3] = _mm512_add_epi64(H[3], D);
+        H[4] = _mm512_add_epi64(H[4], E);
+        H[5] = _mm512_add_epi64(H[5], F);
+        H[6] = _mm512_add_epi64(H[6], G);
+        H[7] = _mm512_add_epi64(H[7], HH);
     }
 
-    return context;
-}
+    // Only active lanes are written back, idle lanes keep their state
+    for (int i = 0; i < 8; ++i)
+    {
+        _mm512_mask_storeu_epi64(state->H[i], activeLanes, H[i]);
+    }
 
+    for (int lane = 0; lane < 8; ++lane)
+    {
+        state->BlockPtrs[lane] = blockPtrs[lane];
+    }
 
-sha2_256_context SHA2_HashStringSHA224(char *messagePtr)
-{
-    return SHA2_HashStringSHA256_(messagePtr, SHA2_DIGEST_LENGTH_SHA224);
+    // Zero out W[] to prevent sensitive information being left in memory
+    if (!state->DisableScrubbing)
+    {
+        SHA2_SecureZero(W, sizeof(W));
+    }
 }
+#endif
 
-sha2_256_context SHA2_HashStringSHA256(char *messagePtr)
+// Note (Aaron): A nibble lookup is much cheaper than sprintf() when hashing many small messages
+static void SHA2_FormatDigestStr(uint8_t const *digestPtr, uint32_t byteCount, char *digestStr)
 {
-    return SHA2_HashStringSHA256_(messagePtr, SHA2_DIGEST_LENGTH_SHA256);
+    static char const hexDigits[] = "0123456789abcdef";
+    for (uint32_t i = 0; i < byteCount; ++i)
+    {
+        digestStr[i*2] = hexDigits[digestPtr[i] >> 4];
+        digestStr[i*2+1] = hexDigits[digestPtr[i] & 0x0f];
+    }
+    digestStr[byteCount * 2] = '\0';
 }
 
-sha2_256_context SHA2_HashFileSHA224(char *fileName)
+// Writes the first DigestLength bits of the hash state in big endian and, if digestStr is not
+// null, the digest as a lowercase hex string
+static void SHA2_WriteDigestSHA256(sha2_256_hash const *state, uint8_t *digestPtr, char *digestStr)
 {
-    return SHA2_HashFileSHA256_(fileName, SHA2_DIGEST_LENGTH_SHA224);
+    sha2_assert(state->DigestLength == SHA2_DIGEST_LENGTH_SHA224 || state->DigestLength == SHA2_DIGEST_LENGTH_SHA256);
+
+    uint32_t byteCount = state->DigestLength / 8;
+    for (uint32_t i = 0; i < byteCount; ++i)
+    {
+        digestPtr[i] = (uint8_t)(state->H[i / 4] >> (24 - (i % 4) * 8));
+    }
+
+    if (digestStr)
+    {
+        SHA2_FormatDigestStr(digestPtr, byteCount, digestStr);
+    }
 }
 
-sha2_256_context SHA2_HashFileSHA256(char *fileName)
+static void SHA2_WriteDigestSHA512(sha2_512_hash const *state, uint8_t *digestPtr, char *digestStr)
 {
-    return SHA2_HashFileSHA256_(fileName, SHA2_DIGEST_LENGTH_SHA256);
-}
+    sha2_assert(state->DigestLength == SHA2_DIGEST_LENGTH_SHA224 || state->DigestLength == SHA2_DIGEST_LENGTH_SHA256 ||
+                state->DigestLength == SHA2_DIGEST_LENGTH_SHA384 || state->DigestLength == SHA2_DIGEST_LENGTH_SHA512);
 
+    uint32_t byteCount = state->DigestLength / 8;
+    for (uint32_t i = 0; i < byteCount; ++i)
+    {
+        digestPtr[i] = (uint8_t)(state->H[i / 8] >> (56 - (i % 8) * 8));
+    }
 
-sha2_512_context SHA2_HashStringSHA512_224(char *messagePtr)
-{
-    return SHA2_HashStringSHA512_(messagePtr, SHA2_DIGEST_LENGTH_SHA224);
+    if (digestStr)
+    {
+        SHA2_FormatDigestStr(digestPtr, byteCount, digestStr);
+    }
 }
 
-sha2_512_context SHA2_HashStringSHA512_256(char *messagePtr)
+static bool SHA2_AddMessageLengthSHA512(uint128_t *messageLengthBits, uint64_t byteCount)
 {
-    return SHA2_HashStringSHA512_(messagePtr, SHA2_DIGEST_LENGTH_SHA256);
-}
+    // Note (Aaron): 'byteCount * 8' can exceed 64 bits so the increment is split into the
+    // bits that land in the high and low halves of the 128-bit message length.
+    uint64_t lowIncrement = byteCount << 3;
+    uint64_t highIncrement = byteCount >> 61;
 
-sha2_512_context SHA2_HashStringSHA384(char *messagePtr)
-{
-    return SHA2_HashStringSHA512_(messagePtr, SHA2_DIGEST_LENGTH_SHA384);
-}
+    uint64_t low = messageLengthBits->Low + lowIncrement;
+    uint64_t high = messageLengthBits->High + highIncrement + ((low < lowIncrement) ? 1 : 0);
 
-sha2_512_context SHA2_HashStringSHA512(char *messagePtr)
-{
-    return SHA2_HashStringSHA512_(messagePtr, SHA2_DIGEST_LENGTH_SHA512);
+    // Note (Aaron): Messages are limited to 2^64 - 1 bytes, which keeps the high half below 8. That
+    // bound is what lets SHA2_ImportStateSHA512() tell a real message length from a corrupted one.
+    if ((high < messageLengthBits->High) || (high >= 8))
+    {
+        return false;
+    }
+
+    messageLengthBits->High = high;
+    messageLengthBits->Low = low;
+
+    return true;
 }
 
-sha2_512_context SHA2_HashFileSHA512_224(char *fileName)
+static sha2_result SHA2_UpdateHashStateSHA256(sha2_256_hash *state, void const *messagePtr, size_t byteCount)
 {
-    return SHA2_HashFileSHA512_(fileName, SHA2_DIGEST_LENGTH_SHA224);
+    if (byteCount == 0)
+    {
+        return SHA2_RESULT_OK;
+    }
+
+    uint8_t *bytePtr = (uint8_t *)messagePtr;
+
+    // Account for the message length once per update rather than once per byte
+    if ((uint64_t)byteCount > ((UINT64_MAX - state->MessageLengthBits) / 8))
+    {
+        sha2_assert(false);
+        return SHA2_RESULT_MESSAGE_TOO_LONG;
+    }
+
+    state->MessageLengthBits += ((uint64_t)byteCount * 8);
+
+    // Top up a partially filled message block before touching the new data
+    if (state->MessageBlockByteCount > 0)
+    {
+        sha2_assert(state->MessageBlockByteCount < SHA2_MESSAGE_BLOCK_SIZE_SHA256);
+
+        size_t fillByteCount = SHA2_MESSAGE_BLOCK_SIZE_SHA256 - state->MessageBlockByteCount;
+        if (fillByteCount > byteCount)
+        {
+            fillByteCount = byteCount;
+        }
+
+        SHA2_MemoryCopy(state->MessageBlock + state->MessageBlockByteCount, bytePtr, fillByteCount);
+        state->MessageBlockByteCount += (uint32_t)fillByteCount;
+        bytePtr += fillByteCount;
+        byteCount -= fillByteCount;
+
+        if (state->MessageBlockByteCount < SHA2_MESSAGE_BLOCK_SIZE_SHA256)
+        {
+            return SHA2_RESULT_OK;
+        }
+
+        SHA2_UpdateHashSHA256(state, state->MessageBlock, SHA2_MESSAGE_BLOCK_SIZE_SHA256);
+        state->MessageBlockByteCount = 0;
+    }
+
+    // Process all whole message blocks directly from the caller's memory
+    size_t wholeBlockByteCount = byteCount - (byteCount % SHA2_MESSAGE_BLOCK_SIZE_SHA256);
+    if (wholeBlockByteCount > 0)
+    {
+        SHA2_UpdateHashSHA256(state, bytePtr, wholeBlockByteCount);
+        bytePtr += wholeBlockByteCount;
+        byteCount -= wholeBlockByteCount;
+    }
+
+    // Hold on to the message remainder until more data arrives or the hash is finalized
+    if (byteCount > 0)
+    {
+        SHA2_MemoryCopy(state->MessageBlock, bytePtr, byteCount);
+        state->MessageBlockByteCount = (uint32_t)byteCount;
+    }
+
+    return SHA2_RESULT_OK;
 }
 
-sha2_512_context SHA2_HashFileSHA512_256(char *fileName)
+static void SHA2_UpdateSHA256_(sha2_256_context *context, void const *messagePtr, size_t byteCount)
 {
-    return SHA2_HashFileSHA512_(fileName, SHA2_DIGEST_LENGTH_SHA256);
+    if (context->Error)
+    {
+        return;
+    }
+
+    if (SHA2_UpdateHashStateSHA256(&context->Hash, messagePtr, byteCount) == SHA2_RESULT_MESSAGE_TOO_LONG)
+    {
+        context->Error = true;
+        sprintf(context->ErrorStr, "Invalid message length: larger than 2^64-1 bits");
+        sprintf(context->DigestStr, "");
+    }
 }
 
-sha2_512_context SHA2_HashFileSHA384(char *fileName)
+static void SHA2_ConstructDigestSHA256_(sha2_256_context *context)
 {
-    return SHA2_HashFileSHA512_(fileName, SHA2_DIGEST_LENGTH_SHA384);
+    // Assert buffer is large enough to hold the longest digest in hex, plus the null terminator
+    sha2_static_assert(SHA2_ArrayCount(context->DigestStr) >= (256 / 4 + 1),
+                  "Buffer is not large enough to hold SHA256 digest");
+
+    SHA2_WriteDigestSHA256(&context->Hash, context->Digest, context->DigestStr);
 }
 
-sha2_512_context SHA2_HashFileSHA512(char *fileName)
+static void SHA2_FinalizeHashStateSHA256(sha2_256_hash *state, uint8_t *digestPtr, char *digestStr)
 {
-    return SHA2_HashFileSHA512_(fileName, SHA2_DIGEST_LENGTH_SHA512);
+    // Note (Aaron): We use a double sized buffer to cover the worst case scenario
+    // where the message remainder + padding + message length cannot fit into one
+    // message block.
+    uint8_t buffer[SHA2_MESSAGE_BLOCK_SIZE_SHA256 * 2];
+    uint32_t remainderByteCount = state->MessageBlockByteCount;
+
+#if HASHUTIL_SLOW
+    // Note (Aaron): Packing the buffer's bits with 1s for debug purposes
+    SHA2_MemorySet(buffer, 0xff, sizeof(buffer));
+#endif
+
+    sha2_assert(remainderByteCount < SHA2_MESSAGE_BLOCK_SIZE_SHA256);
+
+    // Copy message remainder (if any) into buffer
+    if (remainderByteCount > 0)
+    {
+        SHA2_MemoryCopy(buffer, state->MessageBlock, remainderByteCount);
+    }
+
+    // Apply padding to the final message block(s)
+    sha2_message_padding_info messageInfo =
+    {
+        messageInfo.BufferPtr = buffer,
+        messageInfo.BufferSizeBytes = sizeof(buffer),
+        messageInfo.BlockSizeBytes = SHA2_MESSAGE_BLOCK_SIZE_SHA256,
+        messageInfo.MessageRemainderSizeBytes = remainderByteCount,
+        messageInfo.MessageLengthBlockSizeBytes = SHA2_MESSAGE_LENGTH_BLOCK_SHA256,
+        messageInfo.MessageLengthBitsHigh = 0,
+        messageInfo.MessageLengthBitsLow = state->MessageLengthBits,
+    };
+
+    SHA2_ApplyPadding(messageInfo);
+
+    // Apply final hash update and construct the digest
+    bool useFullBuffer = remainderByteCount > (SHA2_MESSAGE_BLOCK_SIZE_SHA256 - SHA2_MESSAGE_LENGTH_BLOCK_SHA256 - 1);
+    uint32_t finalByteCount = useFullBuffer ? sizeof(buffer) : SHA2_MESSAGE_BLOCK_SIZE_SHA256;
+    SHA2_UpdateHashSHA256(state, buffer, finalByteCount);
+    SHA2_WriteDigestSHA256(state, digestPtr, digestStr);
+
+    // Zero out message remainder to prevent sensitive information being left in memory
+    if (!state->DisableScrubbing)
+    {
+        SHA2_SecureZero(buffer, finalByteCount);
+        SHA2_SecureZero(state->MessageBlock, sizeof(state->MessageBlock));
+    }
+    state->MessageBlockByteCount = 0;
+}
+
+static void SHA2_FinalSHA256_(sha2_256_context *context)
+{
+    if (context->Error)
+    {
+        return;
+    }
+
+    SHA2_FinalizeHashStateSHA256(&context->Hash, context->Digest, context->DigestStr);
+}
+
+static sha2_result SHA2_UpdateHashStateSHA512(sha2_512_hash *state, void const *messagePtr, size_t byteCount)
+{
+    if (byteCount == 0)
+    {
+        return SHA2_RESULT_OK;
+    }
+
+    uint8_t *bytePtr = (uint8_t *)messagePtr;
+
+    // Account for the message length once per update rather than once per byte
+    if (!SHA2_AddMessageLengthSHA512(&state->MessageLengthBits, (uint64_t)byteCount))
+    {
+        sha2_assert(false);
+        return SHA2_RESULT_MESSAGE_TOO_LONG;
+    }
+
+    // Top up a partially filled message block before touching the new data
+    if (state->MessageBlockByteCount > 0)
+    {
+        sha2_assert(state->MessageBlockByteCount < SHA2_MESSAGE_BLOCK_SIZE_SHA512);
+
+        size_t fillByteCount = SHA2_MESSAGE_BLOCK_SIZE_SHA512 - state->MessageBlockByteCount;
+        if (fillByteCount > byteCount)
+        {
+            fillByteCount = byteCount;
+        }
+
+        SHA2_MemoryCopy(state->MessageBlock + state->MessageBlockByteCount, bytePtr, fillByteCount);
+        state->MessageBlockByteCount += (uint32_t)fillByteCount;
+        bytePtr += fillByteCount;
+        byteCount -= fillByteCount;
+
+        if (state->MessageBlockByteCount < SHA2_MESSAGE_BLOCK_SIZE_SHA512)
+        {
+            return SHA2_RESULT_OK;
+        }
+
+        SHA2_UpdateHashSHA512(state, state->MessageBlock, SHA2_MESSAGE_BLOCK_SIZE_SHA512);
+        state->MessageBlockByteCount = 0;
+    }
+
+    // Process all whole message blocks directly from the caller's memory
+    size_t wholeBlockByteCount = byteCount - (byteCount % SHA2_MESSAGE_BLOCK_SIZE_SHA512);
+    if (wholeBlockByteCount > 0)
+    {
+        SHA2_UpdateHashSHA512(state, bytePtr, wholeBlockByteCount);
+        bytePtr += wholeBlockByteCount;
+        byteCount -= wholeBlockByteCount;
+    }
+
+    // Hold on to the message remainder until more data arrives or the hash is finalized
+    if (byteCount > 0)
+    {
+        SHA2_MemoryCopy(state->MessageBlock, bytePtr, byteCount);
+        state->MessageBlockByteCount = (uint32_t)byteCount;
+    }
+
+    return SHA2_RESULT_OK;
+}
+
+static void SHA2_UpdateSHA512_(sha2_512_context *context, void const *messagePtr, size_t byteCount)
+{
+    if (context->Error)
+    {
+        return;
+    }
+
+    if (SHA2_UpdateHashStateSHA512(&context->Hash, messagePtr, byteCount) == SHA2_RESULT_MESSAGE_TOO_LONG)
+    {
+        context->Error = true;
+        sprintf(context->ErrorStr, "Invalid message length: larger than 2^64-1 bytes");
+        sprintf(context->DigestStr, "");
+    }
+}
+
+static void SHA2_ConstructDigestSHA512_(sha2_512_context *context)
+{
+    // Assert buffer is large enough to hold the longest digest in hex, plus the null terminator
+    sha2_static_assert(SHA2_ArrayCount(context->DigestStr) >= (512 / 4 + 1),
+                  "Buffer is not large enough to hold SHA512 digest");
+
+    SHA2_WriteDigestSHA512(&context->Hash, context->Digest, context->DigestStr);
+}
+
+static void SHA2_FinalizeHashStateSHA512(sha2_512_hash *state, uint8_t *digestPtr, char *digestStr)
+{
+    // Note (Aaron): We use a double sized buffer to cover the worst case scenario
+    // where the message remainder + padding + message length cannot fit into one
+    // message block.
+    uint8_t buffer[SHA2_MESSAGE_BLOCK_SIZE_SHA512 * 2];
+    uint32_t remainderByteCount = state->MessageBlockByteCount;
+
+#if HASHUTIL_SLOW
+    // Note (Aaron): Packing the buffer's bits with 1s for debug purposes
+    SHA2_MemorySet(buffer, 0xff, sizeof(buffer));
+#endif
+
+    sha2_assert(remainderByteCount < SHA2_MESSAGE_BLOCK_SIZE_SHA512);
+
+    // Copy message remainder (if any) into buffer
+    if (remainderByteCount > 0)
+    {
+        SHA2_MemoryCopy(buffer, state->MessageBlock, remainderByteCount);
+    }
+
+    // Apply padding to the final message blocks(s)
+    sha2_message_padding_info messageInfo =
+    {
+        messageInfo.BufferPtr = buffer,
+        messageInfo.BufferSizeBytes = sizeof(buffer),
+        messageInfo.BlockSizeBytes = SHA2_MESSAGE_BLOCK_SIZE_SHA512,
+        messageInfo.MessageRemainderSizeBytes = remainderByteCount,
+        messageInfo.MessageLengthBlockSizeBytes = SHA2_MESSAGE_LENGTH_BLOCK_SHA512,
+        messageInfo.MessageLengthBitsHigh = state->MessageLengthBits.High,
+        messageInfo.MessageLengthBitsLow = state->MessageLengthBits.Low,
+    };
+
+    SHA2_ApplyPadding(messageInfo);
+
+    // Apply final hash update and construct the digest
+    bool useFullBuffer = remainderByteCount > (SHA2_MESSAGE_BLOCK_SIZE_SHA512 - SHA2_MESSAGE_LENGTH_BLOCK_SHA512 - 1);
+    uint32_t finalByteCount = useFullBuffer ? sizeof(buffer) : SHA2_MESSAGE_BLOCK_SIZE_SHA512;
+    SHA2_UpdateHashSHA512(state, buffer, finalByteCount);
+    SHA2_WriteDigestSHA512(state, digestPtr, digestStr);
+
+    // Zero out message remainder to prevent sensitive information being left in memory
+    if (!state->DisableScrubbing)
+    {
+        SHA2_SecureZero(buffer, finalByteCount);
+        SHA2_SecureZero(state->MessageBlock, sizeof(state->MessageBlock));
+    }
+    state->MessageBlockByteCount = 0;
+}
+
+static void SHA2_FinalSHA512_(sha2_512_context *context)
+{
+    if (context->Error)
+    {
+        return;
+    }
+
+    SHA2_FinalizeHashStateSHA512(&context->Hash, context->Digest, context->DigestStr);
+}
+
+typedef void sha2_256_initialize_state(sha2_256_hash *state);
+typedef void sha2_512_initialize_state(sha2_512_hash *state);
+
+static sha2_result SHA2_DigestBufferSHA256_(void const *messagePtr, size_t byteCount, uint8_t *digestPtr, char *digestStr,
+                                            sha2_256_initialize_state *initializeState)
+{
+    sha2_256_state state;
+    initializeState(&state.Hash);
+
+    sha2_result result = SHA2_UpdateHashStateSHA256(&state.Hash, messagePtr, byteCount);
+    if (result == SHA2_RESULT_OK)
+    {
+        SHA2_FinalizeHashStateSHA256(&state.Hash, digestPtr, digestStr);
+    }
+
+    return result;
+}
+
+static sha2_result SHA2_DigestBufferSHA512_(void const *messagePtr, size_t byteCount, uint8_t *digestPtr, char *digestStr,
+                                            sha2_512_initialize_state *initializeState)
+{
+    sha2_512_state state;
+    initializeState(&state.Hash);
+
+    sha2_result result = SHA2_UpdateHashStateSHA512(&state.Hash, messagePtr, byteCount);
+    if (result == SHA2_RESULT_OK)
+    {
+        SHA2_FinalizeHashStateSHA512(&state.Hash, digestPtr, digestStr);
+    }
+
+    return result;
+}
+
+static bool SHA2_InitializeContextSHA256_(sha2_256_context *context, sha2_digest_length digestLength)
+{
+    switch (digestLength)
+    {
+        case SHA2_DIGEST_LENGTH_SHA224:
+        {
+            SHA2_InitializeContextSHA224(context);
+            return true;
+        }
+        case SHA2_DIGEST_LENGTH_SHA256:
+        {
+            SHA2_InitializeContextSHA256(context);
+            return true;
+        }
+        default:
+        {
+            sha2_assert(false);
+
+            context->Error = true;
+            sprintf(context->ErrorStr, "Invalid digest length for SHA256: %i", digestLength);
+            sprintf(context->DigestStr, "");
+            return false;
+        }
+    }
+}
+
+sha2_256_context SHA2_HashBufferSHA256_(void const *messagePtr, size_t byteCount, sha2_digest_length digestLength)
+{
+    sha2_256_context context;
+    if (!SHA2_InitializeContextSHA256_(&context, digestLength))
+    {
+        return context;
+    }
+
+    SHA2_UpdateSHA256_(&context, messagePtr, byteCount);
+    SHA2_FinalSHA256_(&context);
+
+    return context;
+}
+
+sha2_256_context SHA2_HashFileSHA256_(char *fileName, sha2_digest_length digestLength)
+{
+    sha2_256_context context;
+    if (!SHA2_InitializeContextSHA256_(&context, digestLength))
+    {
+        return context;
+    }
+
+    FILE *file = fopen(fileName, "rb");
+    if (!file)
+    {
+        sha2_assert(false);
+
+        context.Error = true;
+        sprintf(context.ErrorStr, "Unable to open file");
+        sprintf(context.DigestStr, "");
+        return context;
+    }
+
+    // Note (Aaron): Read the file many message blocks at a time so that SHA2_UpdateSHA256_() can
+    // hash whole blocks in bulk. Short reads are fine as the remainder is buffered.
+    uint8_t buffer[SHA2_MESSAGE_BLOCK_SIZE_SHA256 * SHA2_FILE_READ_BLOCK_COUNT];
+    size_t bytesRead = fread(buffer, sizeof(uint8_t), sizeof(buffer), file);
+    while (bytesRead > 0 && !context.Error)
+    {
+        SHA2_UpdateSHA256_(&context, buffer, bytesRead);
+        bytesRead = fread(buffer, sizeof(uint8_t), sizeof(buffer), file);
+    }
+
+    if (ferror(file))
+    {
+        fclose(file);
+        sha2_assert(false);
+
+        context.Error = true;
+        sprintf(context.ErrorStr, "Error reading file");
+        sprintf(context.DigestStr, "");
+        return context;
+    }
+
+    fclose(file);
+
+    // Zero out buffer to sanitize potentially sensitive information
+    SHA2_SecureZero(buffer, sizeof(buffer));
+
+    SHA2_FinalSHA256_(&context);
+
+    return context;
+}
+
+typedef struct
+{
+    sha2_256_context *Context;
+    uint64_t BlockCount;
+    bool IsHashingTail;
+
+    // Note (Aaron): The message remainder, padding and message length are hashed from here
+    // once the lane has finished the message's whole blocks.
+    uint8_t TailBlocks[SHA2_MESSAGE_BLOCK_SIZE_SHA256 * 2];
+    uint64_t TailBlockCount;
+} sha2_256_multi_buffer_job;
+
+static bool SHA2_StartMultiBufferJobSHA256(sha2_256_multi_buffer_state *state, uint32_t lane,
+                                           sha2_256_multi_buffer_job *job, sha2_256_context *context,
+                                           void const *messagePtr, size_t byteCount, sha2_digest_length digestLength)
+{
+    if (!SHA2_InitializeContextSHA256_(context, digestLength))
+    {
+        return false;
+    }
+
+    if ((uint64_t)byteCount > (UINT64_MAX / 8))
+    {
+        sha2_assert(false);
+
+        context->Error = true;
+        sprintf(context->ErrorStr, "Invalid message length: larger than 2^64-1 bits");
+        sprintf(context->DigestStr, "");
+        return false;
+    }
+
+    context->Hash.MessageLengthBits = (uint64_t)byteCount * 8;
+
+    uint64_t remainderByteCount = byteCount % SHA2_MESSAGE_BLOCK_SIZE_SHA256;
+    uint64_t wholeBlockByteCount = byteCount - remainderByteCount;
+
+    if (remainderByteCount > 0)
+    {
+        SHA2_MemoryCopy(job->TailBlocks, (uint8_t const *)messagePtr + wholeBlockByteCount, remainderByteCount);
+    }
+
+    sha2_message_padding_info messageInfo =
+    {
+        messageInfo.BufferPtr = job->TailBlocks,
+        messageInfo.BufferSizeBytes = sizeof(job->TailBlocks),
+        messageInfo.BlockSizeBytes = SHA2_MESSAGE_BLOCK_SIZE_SHA256,
+        messageInfo.MessageRemainderSizeBytes = remainderByteCount,
+        messageInfo.MessageLengthBlockSizeBytes = SHA2_MESSAGE_LENGTH_BLOCK_SHA256,
+        messageInfo.MessageLengthBitsHigh = 0,
+        messageInfo.MessageLengthBitsLow = context->Hash.MessageLengthBits,
+    };
+
+    SHA2_ApplyPadding(messageInfo);
+
+    bool useFullBuffer = remainderByteCount > (SHA2_MESSAGE_BLOCK_SIZE_SHA256 - SHA2_MESSAGE_LENGTH_BLOCK_SHA256 - 1);
+    job->TailBlockCount = useFullBuffer ? 2 : 1;
+    job->Context = context;
+
+    if (wholeBlockByteCount > 0)
+    {
+        state->BlockPtrs[lane] = (uint8_t const *)messagePtr;
+        job->BlockCount = wholeBlockByteCount / SHA2_MESSAGE_BLOCK_SIZE_SHA256;
+        job->IsHashingTail = false;
+    }
+    else
+    {
+        state->BlockPtrs[lane] = job->TailBlocks;
+        job->BlockCount = job->TailBlockCount;
+        job->IsHashingTail = true;
+    }
+
+    for (int i = 0; i < 8; ++i)
+    {
+        state->H[i][lane] = context->Hash.H[i];
+    }
+
+    return true;
+}
+
+static void SHA2_FinishMultiBufferJobSHA256(sha2_256_multi_buffer_state *state, uint32_t lane, sha2_256_multi_buffer_job *job)
+{
+    sha2_256_context *context = job->Context;
+
+    for (int i = 0; i < 8; ++i)
+    {
+        context->Hash.H[i] = state->H[i][lane];
+    }
+
+    SHA2_ConstructDigestSHA256_(context);
+
+    // Zero out message remainder to prevent sensitive information being left in memory
+    if (!context->Hash.DisableScrubbing)
+    {
+        SHA2_SecureZero(job->TailBlocks, sizeof(job->TailBlocks));
+    }
+}
+
+// Note (Aaron): Keeps every lane of the kernel busy by refilling lanes with the next message as soon
+// as their current message is finished. Each kernel call runs the fewest blocks any active lane has
+// left, so lanes only ever idle once no messages remain.
+static void SHA2_HashBuffersSHA256MultiBuffer(sha2_256_context *contexts, void const * const *messagePtrs,
+                                              size_t const *byteCounts, size_t count, sha2_digest_length digestLength,
+                                              sha2_256_multi_buffer_kernel *kernel, uint32_t laneCount)
+{
+    sha2_assert(laneCount <= SHA2_MULTI_BUFFER_MAX_LANES);
+
+    sha2_256_multi_buffer_state state;
+    sha2_256_multi_buffer_job jobs[SHA2_MULTI_BUFFER_MAX_LANES];
+
+    // Note (Aaron): The contexts a batch produces start out scrubbing, so the kernels scrub too
+    state.DisableScrubbing = false;
+
+    for (uint32_t lane = 0; lane < SHA2_MULTI_BUFFER_MAX_LANES; ++lane)
+    {
+        state.BlockPtrs[lane] = SHA2_IdleMessageBlock;
+    }
+
+    uint32_t laneMask = 0;
+    size_t nextMessage = 0;
+
+    for (;;)
+    {
+        // Refill idle lanes with the next messages
+        for (uint32_t lane = 0; lane < laneCount; ++lane)
+        {
+            while (!(laneMask & (1 << lane)) && nextMessage < count)
+            {
+                if (SHA2_StartMultiBufferJobSHA256(&state, lane, &jobs[lane], &contexts[nextMessage],
+                                                   messagePtrs[nextMessage], byteCounts[nextMessage], digestLength))
+                {
+                    laneMask |= (1 << lane);
+                }
+
+                nextMessage++;
+            }
+        }
+
+        if (laneMask == 0)
+        {
+            break;
+        }
+
+        uint64_t blockCount = UINT64_MAX;
+        for (uint32_t lane = 0; lane < laneCount; ++lane)
+        {
+            if ((laneMask & (1 << lane)) && jobs[lane].BlockCount < blockCount)
+            {
+                blockCount = jobs[lane].BlockCount;
+            }
+        }
+
+        kernel(&state, laneMask, blockCount);
+
+        for (uint32_t lane = 0; lane < laneCount; ++lane)
+        {
+            if (!(laneMask & (1 << lane)))
+            {
+                continue;
+            }
+
+            sha2_256_multi_buffer_job *job = &jobs[lane];
+            job->BlockCount -= blockCount;
+
+            if (job->BlockCount > 0)
+            {
+                continue;
+            }
+
+            if (!job->IsHashingTail)
+            {
+                state.BlockPtrs[lane] = job->TailBlocks;
+                job->BlockCount = job->TailBlockCount;
+                job->IsHashingTail = true;
+                continue;
+            }
+
+            SHA2_FinishMultiBufferJobSHA256(&state, lane, job);
+            state.BlockPtrs[lane] = SHA2_IdleMessageBlock;
+            laneMask &= ~(1 << lane);
+        }
+    }
+}
+
+static void SHA2_HashBuffersSHA256_(sha2_256_context *contexts, void const * const *messagePtrs,
+                                    size_t const *byteCounts, size_t count, sha2_digest_length digestLength)
+{
+#if SHA2_X64
+    // Note (Aaron): A single SHA extensions stream outruns eight AVX2 lanes, while sixteen AVX-512
+    // lanes are about twice as fast once every lane has a message. With the SHA extensions the
+    // AVX-512 engine is only worth it when the batch can fill all sixteen lanes; smaller batches are
+    // hashed one message at a time. Interleaving two SHA extensions streams measured no faster.
+    bool hasSHAExtensions = SHA2_HasCPUFeatures(SHA2_CPU_FEATURE_SHA | SHA2_CPU_FEATURE_SSE41 | SHA2_CPU_FEATURE_SSSE3)
+        && SHA2_IsKernelAllowed("shani");
+    size_t minimumCount = hasSHAExtensions ? 16 : 2;
+
+    if (count >= minimumCount && SHA2_HasCPUFeatures(SHA2_CPU_FEATURE_AVX512F | SHA2_CPU_FEATURE_AVX512BW)
+        && SHA2_IsKernelAllowed("avx512"))
+    {
+        SHA2_HashBuffersSHA256MultiBuffer(contexts, messagePtrs, byteCounts, count, digestLength,
+                                          SHA2_UpdateHashSHA256x16AVX512, 16);
+        return;
+    }
+
+    if (count >= minimumCount && !hasSHAExtensions && SHA2_HasCPUFeatures(SHA2_CPU_FEATURE_AVX2)
+        && SHA2_IsKernelAllowed("avx2"))
+    {
+        SHA2_HashBuffersSHA256MultiBuffer(contexts, messagePtrs, byteCounts, count, digestLength,
+                                          SHA2_UpdateHashSHA256x8AVX2, 8);
+        return;
+    }
+#endif
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        contexts[i] = SHA2_HashBufferSHA256_(messagePtrs[i], byteCounts[i], digestLength);
+    }
+}
+
+static bool SHA2_InitializeContextSHA512_(sha2_512_context *context, sha2_digest_length digestLength)
+{
+    switch (digestLength)
+    {
+        case SHA2_DIGEST_LENGTH_SHA224:
+        {
+            SHA2_InitializeContextSHA512_224(context);
+            return true;
+        }
+        case SHA2_DIGEST_LENGTH_SHA256:
+        {
+            SHA2_InitializeContextSHA512_256(context);
+            return true;
+        }
+        case SHA2_DIGEST_LENGTH_SHA384:
+        {
+            SHA2_InitializeContextSHA384(context);
+            return true;
+        }
+        case SHA2_DIGEST_LENGTH_SHA512:
+        {
+            SHA2_InitializeContextSHA512(context);
+            return true;
+        }
+        default:
+        {
+            sha2_assert(false);
+
+            context->Error = true;
+            sprintf(context->ErrorStr, "Invalid digest length for SHA512: %i", digestLength);
+            sprintf(context->DigestStr, "");
+            return false;
+        }
+    }
+}
+
+sha2_512_context SHA2_HashBufferSHA512_(void const *messagePtr, size_t byteCount, sha2_digest_length digestLength)
+{
+    sha2_512_context context;
+    if (!SHA2_InitializeContextSHA512_(&context, digestLength))
+    {
+        return context;
+    }
+
+    SHA2_UpdateSHA512_(&context, messagePtr, byteCount);
+    SHA2_FinalSHA512_(&context);
+
+    return context;
+}
+
+sha2_512_context SHA2_HashFileSHA512_(char *fileName, sha2_digest_length digestLength)
+{
+    sha2_512_context context;
+    if (!SHA2_InitializeContextSHA512_(&context, digestLength))
+    {
+        return context;
+    }
+
+    FILE *file = fopen(fileName, "rb");
+    if (!file)
+    {
+        sha2_assert(false);
+
+        context.Error = true;
+        sprintf(context.ErrorStr, "Unable to open file");
+        sprintf(context.DigestStr, "");
+        return context;
+    }
+
+    // Note (Aaron): Read the file many message blocks at a time so that SHA2_UpdateSHA512_() can
+    // hash whole blocks in bulk. Short reads are fine as the remainder is buffered.
+    uint8_t buffer[SHA2_MESSAGE_BLOCK_SIZE_SHA512 * SHA2_FILE_READ_BLOCK_COUNT];
+    size_t bytesRead = fread(buffer, sizeof(uint8_t), sizeof(buffer), file);
+    while (bytesRead > 0 && !context.Error)
+    {
+        SHA2_UpdateSHA512_(&context, buffer, bytesRead);
+        bytesRead = fread(buffer, sizeof(uint8_t), sizeof(buffer), file);
+    }
+
+    if (ferror(file))
+    {
+        fclose(file);
+        sha2_assert(false);
+
+        context.Error = true;
+        sprintf(context.ErrorStr, "Error reading file");
+        sprintf(context.DigestStr, "");
+        return context;
+    }
+
+    fclose(file);
+
+    // Zero out buffer to sanitize potentially sensitive information
+    SHA2_SecureZero(buffer, sizeof(buffer));
+
+    SHA2_FinalSHA512_(&context);
+
+    return context;
+}
+
+typedef struct
+{
+    sha2_512_context *Context;
+    uint64_t BlockCount;
+    bool IsHashingTail;
+
+    // Note (Aaron): The message remainder, padding and message length are hashed from here
+    // once the lane has finished the message's whole blocks.
+    uint8_t TailBlocks[SHA2_MESSAGE_BLOCK_SIZE_SHA512 * 2];
+    uint64_t TailBlockCount;
+} sha2_512_multi_buffer_job;
+
+static bool SHA2_StartMultiBufferJobSHA512(sha2_512_multi_buffer_state *state, uint32_t lane,
+                                           sha2_512_multi_buffer_job *job, sha2_512_context *context,
+                                           void const *messagePtr, size_t byteCount, sha2_digest_length digestLength)
+{
+    if (!SHA2_InitializeContextSHA512_(context, digestLength))
+    {
+        return false;
+    }
+
+    // Note (Aaron): A size_t byte count always fits within the 128-bit message length
+    SHA2_AddMessageLengthSHA512(&context->Hash.MessageLengthBits, (uint64_t)byteCount);
+
+    uint64_t remainderByteCount = byteCount % SHA2_MESSAGE_BLOCK_SIZE_SHA512;
+    uint64_t wholeBlockByteCount = byteCount - remainderByteCount;
+
+    if (remainderByteCount > 0)
+    {
+        SHA2_MemoryCopy(job->TailBlocks, (uint8_t const *)messagePtr + wholeBlockByteCount, remainderByteCount);
+    }
+
+    sha2_message_padding_info messageInfo =
+    {
+        messageInfo.BufferPtr = job->TailBlocks,
+        messageInfo.BufferSizeBytes = sizeof(job->TailBlocks),
+        messageInfo.BlockSizeBytes = SHA2_MESSAGE_BLOCK_SIZE_SHA512,
+        messageInfo.MessageRemainderSizeBytes = remainderByteCount,
+        messageInfo.MessageLengthBlockSizeBytes = SHA2_MESSAGE_LENGTH_BLOCK_SHA512,
+        messageInfo.MessageLengthBitsHigh = context->Hash.MessageLengthBits.High,
+        messageInfo.MessageLengthBitsLow = context->Hash.MessageLengthBits.Low,
+    };
+
+    SHA2_ApplyPadding(messageInfo);
+
+    bool useFullBuffer = remainderByteCount > (SHA2_MESSAGE_BLOCK_SIZE_SHA512 - SHA2_MESSAGE_LENGTH_BLOCK_SHA512 - 1);
+    job->TailBlockCount = useFullBuffer ? 2 : 1;
+    job->Context = context;
+
+    if (wholeBlockByteCount > 0)
+    {
+        state->BlockPtrs[lane] = (uint8_t const *)messagePtr;
+        job->BlockCount = wholeBlockByteCount / SHA2_MESSAGE_BLOCK_SIZE_SHA512;
+        job->IsHashingTail = false;
+    }
+    else
+    {
+        state->BlockPtrs[lane] = job->TailBlocks;
+        job->BlockCount = job->TailBlockCount;
+        job->IsHashingTail = true;
+    }
+
+    for (int i = 0; i < 8; ++i)
+    {
+        state->H[i][lane] = context->Hash.H[i];
+    }
+
+    return true;
+}
+
+static void SHA2_FinishMultiBufferJobSHA512(sha2_512_multi_buffer_state *state, uint32_t lane, sha2_512_multi_buffer_job *job)
+{
+    sha2_512_context *context = job->Context;
+
+    for (int i = 0; i < 8; ++i)
+    {
+        context->Hash.H[i] = state->H[i][lane];
+    }
+
+    SHA2_ConstructDigestSHA512_(context);
+
+    // Zero out message remainder to prevent sensitive information being left in memory
+    if (!context->Hash.DisableScrubbing)
+    {
+        SHA2_SecureZero(job->TailBlocks, sizeof(job->TailBlocks));
+    }
+}
+
+// Note (Aaron): Same lane scheduling as SHA2_HashBuffersSHA256MultiBuffer() for 64-bit state words
+static void SHA2_HashBuffersSHA512MultiBuffer(sha2_512_context *contexts, void const * const *messagePtrs,
+                                              size_t const *byteCounts, size_t count, sha2_digest_length digestLength,
+                                              sha2_512_multi_buffer_kernel *kernel, uint32_t laneCount)
+{
+    sha2_assert(laneCount <= SHA2_MULTI_BUFFER_MAX_LANES);
+
+    sha2_512_multi_buffer_state state;
+    sha2_512_multi_buffer_job jobs[SHA2_MULTI_BUFFER_MAX_LANES];
+
+    // Note (Aaron): The contexts a batch produces start out scrubbing, so the kernels scrub too
+    state.DisableScrubbing = false;
+
+    for (uint32_t lane = 0; lane < SHA2_MULTI_BUFFER_MAX_LANES; ++lane)
+    {
+        state.BlockPtrs[lane] = SHA2_IdleMessageBlock;
+    }
+
+    uint32_t laneMask = 0;
+    size_t nextMessage = 0;
+
+    for (;;)
+    {
+        // Refill idle lanes with the next messages
+        for (uint32_t lane = 0; lane < laneCount; ++lane)
+        {
+            while (!(laneMask & (1 << lane)) && nextMessage < count)
+            {
+                if (SHA2_StartMultiBufferJobSHA512(&state, lane, &jobs[lane], &contexts[nextMessage],
+                                                   messagePtrs[nextMessage], byteCounts[nextMessage], digestLength))
+                {
+                    laneMask |= (1 << lane);
+                }
+
+                nextMessage++;
+            }
+        }
+
+        if (laneMask == 0)
+        {
+            break;
+        }
+
+        uint64_t blockCount = UINT64_MAX;
+        for (uint32_t lane = 0; lane < laneCount; ++lane)
+        {
+            if ((laneMask & (1 << lane)) && jobs[lane].BlockCount < blockCount)
+            {
+                blockCount = jobs[lane].BlockCount;
+            }
+        }
+
+        kernel(&state, laneMask, blockCount);
+
+        for (uint32_t lane = 0; lane < laneCount; ++lane)
+        {
+            if (!(laneMask & (1 << lane)))
+            {
+                continue;
+            }
+
+            sha2_512_multi_buffer_job *job = &jobs[lane];
+            job->BlockCount -= blockCount;
+
+            if (job->BlockCount > 0)
+            {
+                continue;
+            }
+
+            if (!job->IsHashingTail)
+            {
+                state.BlockPtrs[lane] = job->TailBlocks;
+                job->BlockCount = job->TailBlockCount;
+                job->IsHashingTail = true;
+                continue;
+            }
+
+            SHA2_FinishMultiBufferJobSHA512(&state, lane, job);
+            state.BlockPtrs[lane] = SHA2_IdleMessageBlock;
+            laneMask &= ~(1 << lane);
+        }
+    }
+}
+
+static void SHA2_HashBuffersSHA512_(sha2_512_context *contexts, void const * const *messagePtrs,
+                                    size_t const *byteCounts, size_t count, sha2_digest_length digestLength)
+{
+#if SHA2_X64
+    // Note (Aaron): There are no SHA extensions for SHA512 on x86-64, so any batch of two or more
+    // messages is faster through the multi-buffer engines than through the scalar kernel.
+    if (count > 1 && SHA2_HasCPUFeatures(SHA2_CPU_FEATURE_AVX512F | SHA2_CPU_FEATURE_AVX512BW)
+        && SHA2_IsKernelAllowed("avx512"))
+    {
+        SHA2_HashBuffersSHA512MultiBuffer(contexts, messagePtrs, byteCounts, count, digestLength,
+                                          SHA2_UpdateHashSHA512x8AVX512, 8);
+        return;
+    }
+
+    if (count > 1 && SHA2_HasCPUFeatures(SHA2_CPU_FEATURE_AVX2) && SHA2_IsKernelAllowed("avx2"))
+    {
+        SHA2_HashBuffersSHA512MultiBuffer(contexts, messagePtrs, byteCounts, count, digestLength,
+                                          SHA2_UpdateHashSHA512x4AVX2, 4);
+        return;
+    }
+#endif
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        contexts[i] = SHA2_HashBufferSHA512_(messagePtrs[i], byteCounts[i], digestLength);
+    }
+}
+
+sha2_256_context SHA2_HashStringSHA224(char *messagePtr)
+{
+    return SHA2_HashBufferSHA256_(messagePtr, strlen(messagePtr), SHA2_DIGEST_LENGTH_SHA224);
+}
+
+sha2_256_context SHA2_HashStringSHA256(char *messagePtr)
+{
+    return SHA2_HashBufferSHA256_(messagePtr, strlen(messagePtr), SHA2_DIGEST_LENGTH_SHA256);
+}
+
+sha2_256_context SHA2_HashFileSHA224(char *fileName)
+{
+    return SHA2_HashFileSHA256_(fileName, SHA2_DIGEST_LENGTH_SHA224);
+}
+
+sha2_256_context SHA2_HashFileSHA256(char *fileName)
+{
+    return SHA2_HashFileSHA256_(fileName, SHA2_DIGEST_LENGTH_SHA256);
+}
+
+sha2_256_context SHA2_HashBufferSHA224(void const *messagePtr, size_t byteCount)
+{
+    return SHA2_HashBufferSHA256_(messagePtr, byteCount, SHA2_DIGEST_LENGTH_SHA224);
+}
+
+sha2_256_context SHA2_HashBufferSHA256(void const *messagePtr, size_t byteCount)
+{
+    return SHA2_HashBufferSHA256_(messagePtr, byteCount, SHA2_DIGEST_LENGTH_SHA256);
+}
+
+void SHA2_HashBuffersSHA224(sha2_256_context *contexts, void const * const *messagePtrs, size_t const *byteCounts, size_t count)
+{
+    SHA2_HashBuffersSHA256_(contexts, messagePtrs, byteCounts, count, SHA2_DIGEST_LENGTH_SHA224);
+}
+
+void SHA2_HashBuffersSHA256(sha2_256_context *contexts, void const * const *messagePtrs, size_t const *byteCounts, size_t count)
+{
+    SHA2_HashBuffersSHA256_(contexts, messagePtrs, byteCounts, count, SHA2_DIGEST_LENGTH_SHA256);
+}
+
+
+sha2_512_context SHA2_HashStringSHA512_224(char *messagePtr)
+{
+    return SHA2_HashBufferSHA512_(messagePtr, strlen(messagePtr), SHA2_DIGEST_LENGTH_SHA224);
+}
+
+sha2_512_context SHA2_HashStringSHA512_256(char *messagePtr)
+{
+    return SHA2_HashBufferSHA512_(messagePtr, strlen(messagePtr), SHA2_DIGEST_LENGTH_SHA256);
+}
+
+sha2_512_context SHA2_HashStringSHA384(char *messagePtr)
+{
+    return SHA2_HashBufferSHA512_(messagePtr, strlen(messagePtr), SHA2_DIGEST_LENGTH_SHA384);
+}
+
+sha2_512_context SHA2_HashStringSHA512(char *messagePtr)
+{
+    return SHA2_HashBufferSHA512_(messagePtr, strlen(messagePtr), SHA2_DIGEST_LENGTH_SHA512);
+}
+
+sha2_512_context SHA2_HashFileSHA512_224(char *fileName)
+{
+    return SHA2_HashFileSHA512_(fileName, SHA2_DIGEST_LENGTH_SHA224);
+}
+
+sha2_512_context SHA2_HashFileSHA512_256(char *fileName)
+{
+    return SHA2_HashFileSHA512_(fileName, SHA2_DIGEST_LENGTH_SHA256);
+}
+
+sha2_512_context SHA2_HashFileSHA384(char *fileName)
+{
+    return SHA2_HashFileSHA512_(fileName, SHA2_DIGEST_LENGTH_SHA384);
+}
+
+sha2_512_context SHA2_HashFileSHA512(char *fileName)
+{
+    return SHA2_HashFileSHA512_(fileName, SHA2_DIGEST_LENGTH_SHA512);
+}
+
+sha2_512_context SHA2_HashBufferSHA512_224(void const *messagePtr, size_t byteCount)
+{
+    return SHA2_HashBufferSHA512_(messagePtr, byteCount, SHA2_DIGEST_LENGTH_SHA224);
+}
+
+sha2_512_context SHA2_HashBufferSHA512_256(void const *messagePtr, size_t byteCount)
+{
+    return SHA2_HashBufferSHA512_(messagePtr, byteCount, SHA2_DIGEST_LENGTH_SHA256);
+}
+
+sha2_512_context SHA2_HashBufferSHA384(void const *messagePtr, size_t byteCount)
+{
+    return SHA2_HashBufferSHA512_(messagePtr, byteCount, SHA2_DIGEST_LENGTH_SHA384);
+}
+
+sha2_512_context SHA2_HashBufferSHA512(void const *messagePtr, size_t byteCount)
+{
+    return SHA2_HashBufferSHA512_(messagePtr, byteCount, SHA2_DIGEST_LENGTH_SHA512);
+}
+
+void SHA2_HashBuffersSHA512_224(sha2_512_context *contexts, void const * const *messagePtrs, size_t const *byteCounts, size_t count)
+{
+    SHA2_HashBuffersSHA512_(contexts, messagePtrs, byteCounts, count, SHA2_DIGEST_LENGTH_SHA224);
+}
+
+void SHA2_HashBuffersSHA512_256(sha2_512_context *contexts, void const * const *messagePtrs, size_t const *byteCounts, size_t count)
+{
+    SHA2_HashBuffersSHA512_(contexts, messagePtrs, byteCounts, count, SHA2_DIGEST_LENGTH_SHA256);
+}
+
+void SHA2_HashBuffersSHA384(sha2_512_context *contexts, void const * const *messagePtrs, size_t const *byteCounts, size_t count)
+{
+    SHA2_HashBuffersSHA512_(contexts, messagePtrs, byteCounts, count, SHA2_DIGEST_LENGTH_SHA384);
+}
+
+void SHA2_HashBuffersSHA512(sha2_512_context *contexts, void const * const *messagePtrs, size_t const *byteCounts, size_t count)
+{
+    SHA2_HashBuffersSHA512_(contexts, messagePtrs, byteCounts, count, SHA2_DIGEST_LENGTH_SHA512);
+}
+
+
+void SHA2_InitSHA224(sha2_256_context *context)
+{
+    SHA2_InitializeContextSHA224(context);
+}
+
+void SHA2_UpdateSHA224(sha2_256_context *context, void const *messagePtr, size_t byteCount)
+{
+    SHA2_UpdateSHA256_(context, messagePtr, byteCount);
+}
+
+void SHA2_FinalSHA224(sha2_256_context *context)
+{
+    SHA2_FinalSHA256_(context);
+}
+
+void SHA2_InitSHA256(sha2_256_context *context)
+{
+    SHA2_InitializeContextSHA256(context);
+}
+
+void SHA2_UpdateSHA256(sha2_256_context *context, void const *messagePtr, size_t byteCount)
+{
+    SHA2_UpdateSHA256_(context, messagePtr, byteCount);
+}
+
+void SHA2_FinalSHA256(sha2_256_context *context)
+{
+    SHA2_FinalSHA256_(context);
+}
+
+
+void SHA2_InitSHA512_224(sha2_512_context *context)
+{
+    SHA2_InitializeContextSHA512_224(context);
+}
+
+void SHA2_UpdateSHA512_224(sha2_512_context *context, void const *messagePtr, size_t byteCount)
+{
+    SHA2_UpdateSHA512_(context, messagePtr, byteCount);
+}
+
+void SHA2_FinalSHA512_224(sha2_512_context *context)
+{
+    SHA2_FinalSHA512_(context);
+}
+
+void SHA2_InitSHA512_256(sha2_512_context *context)
+{
+    SHA2_InitializeContextSHA512_256(context);
+}
+
+void SHA2_UpdateSHA512_256(sha2_512_context *context, void const *messagePtr, size_t byteCount)
+{
+    SHA2_UpdateSHA512_(context, messagePtr, byteCount);
+}
+
+void SHA2_FinalSHA512_256(sha2_512_context *context)
+{
+    SHA2_FinalSHA512_(context);
+}
+
+void SHA2_InitSHA384(sha2_512_context *context)
+{
+    SHA2_InitializeContextSHA384(context);
+}
+
+void SHA2_UpdateSHA384(sha2_512_context *context, void const *messagePtr, size_t byteCount)
+{
+    SHA2_UpdateSHA512_(context, messagePtr, byteCount);
+}
+
+void SHA2_FinalSHA384(sha2_512_context *context)
+{
+    SHA2_FinalSHA512_(context);
+}
+
+void SHA2_InitSHA512(sha2_512_context *context)
+{
+    SHA2_InitializeContextSHA512(context);
+}
+
+void SHA2_UpdateSHA512(sha2_512_context *context, void const *messagePtr, size_t byteCount)
+{
+    SHA2_UpdateSHA512_(context, messagePtr, byteCount);
+}
+
+void SHA2_FinalSHA512(sha2_512_context *context)
+{
+    SHA2_FinalSHA512_(context);
+}
+
+
+void SHA2_InitStateSHA224(sha2_256_state *state)
+{
+    SHA2_InitializeStateSHA224(&state->Hash);
+}
+
+void SHA2_InitStateSHA256(sha2_256_state *state)
+{
+    SHA2_InitializeStateSHA256(&state->Hash);
+}
+
+sha2_result SHA2_UpdateStateSHA256(sha2_256_state *state, void const *messagePtr, size_t byteCount)
+{
+    return SHA2_UpdateHashStateSHA256(&state->Hash, messagePtr, byteCount);
+}
+
+void SHA2_FinalStateSHA256(sha2_256_state *state, uint8_t *digestPtr, char *digestStr)
+{
+    SHA2_FinalizeHashStateSHA256(&state->Hash, digestPtr, digestStr);
+}
+
+sha2_result SHA2_DigestBufferSHA224(void const *messagePtr, size_t byteCount, uint8_t *digestPtr, char *digestStr)
+{
+    return SHA2_DigestBufferSHA256_(messagePtr, byteCount, digestPtr, digestStr, SHA2_InitializeStateSHA224);
+}
+
+sha2_result SHA2_DigestBufferSHA256(void const *messagePtr, size_t byteCount, uint8_t *digestPtr, char *digestStr)
+{
+    return SHA2_DigestBufferSHA256_(messagePtr, byteCount, digestPtr, digestStr, SHA2_InitializeStateSHA256);
+}
+
+
+void SHA2_InitStateSHA512_224(sha2_512_state *state)
+{
+    SHA2_InitializeStateSHA512_224(&state->Hash);
+}
+
+void SHA2_InitStateSHA512_256(sha2_512_state *state)
+{
+    SHA2_InitializeStateSHA512_256(&state->Hash);
+}
+
+void SHA2_InitStateSHA384(sha2_512_state *state)
+{
+    SHA2_InitializeStateSHA384(&state->Hash);
+}
+
+void SHA2_InitStateSHA512(sha2_512_state *state)
+{
+    SHA2_InitializeStateSHA512(&state->Hash);
+}
+
+sha2_result SHA2_UpdateStateSHA512(sha2_512_state *state, void const *messagePtr, size_t byteCount)
+{
+    return SHA2_UpdateHashStateSHA512(&state->Hash, messagePtr, byteCount);
+}
+
+void SHA2_FinalStateSHA512(sha2_512_state *state, uint8_t *digestPtr, char *digestStr)
+{
+    SHA2_FinalizeHashStateSHA512(&state->Hash, digestPtr, digestStr);
+}
+
+sha2_result SHA2_DigestBufferSHA512_224(void const *messagePtr, size_t byteCount, uint8_t *digestPtr, char *digestStr)
+{
+    return SHA2_DigestBufferSHA512_(messagePtr, byteCount, digestPtr, digestStr, SHA2_InitializeStateSHA512_224);
+}
+
+sha2_result SHA2_DigestBufferSHA512_256(void const *messagePtr, size_t byteCount, uint8_t *digestPtr, char *digestStr)
+{
+    return SHA2_DigestBufferSHA512_(messagePtr, byteCount, digestPtr, digestStr, SHA2_InitializeStateSHA512_256);
+}
+
+sha2_result SHA2_DigestBufferSHA384(void const *messagePtr, size_t byteCount, uint8_t *digestPtr, char *digestStr)
+{
+    return SHA2_DigestBufferSHA512_(messagePtr, byteCount, digestPtr, digestStr, SHA2_InitializeStateSHA384);
+}
+
+sha2_result SHA2_DigestBufferSHA512(void const *messagePtr, size_t byteCount, uint8_t *digestPtr, char *digestStr)
+{
+    return SHA2_DigestBufferSHA512_(messagePtr, byteCount, digestPtr, digestStr, SHA2_InitializeStateSHA512);
+}
+
+
+void SHA2_ExportStateSHA256(sha2_256_hash const *state, uint8_t *bufferPtr)
+{
+    sha2_assert(state->MessageBlockByteCount < SHA2_MESSAGE_BLOCK_SIZE_SHA256);
+
+    SHA2_MemoryCopy(bufferPtr, "S256", 4);
+    SHA2_StoreBE32(bufferPtr + 4, SHA2_STATE_FORMAT_VERSION);
+    SHA2_StoreBE32(bufferPtr + 8, state->DigestLength);
+
+    for (int i = 0; i < 8; ++i)
+    {
+        SHA2_StoreBE32(bufferPtr + 12 + (i * 4), state->H[i]);
+    }
+
+    SHA2_StoreBE64(bufferPtr + 44, state->MessageLengthBits);
+    SHA2_StoreBE32(bufferPtr + 52, state->MessageBlockByteCount);
+
+    // Note (Aaron): Only the buffered bytes are copied so stale block contents never leave the state
+    uint8_t *blockPtr = bufferPtr + 56;
+    SHA2_MemorySet(blockPtr, 0, SHA2_MESSAGE_BLOCK_SIZE_SHA256);
+    if (state->MessageBlockByteCount > 0)
+    {
+        SHA2_MemoryCopy(blockPtr, state->MessageBlock, state->MessageBlockByteCount);
+    }
+}
+
+sha2_result SHA2_ImportStateSHA256(sha2_256_hash *state, uint8_t const *bufferPtr)
+{
+    uint32_t digestLength = SHA2_LoadBE32(bufferPtr + 8);
+    uint64_t messageLengthBits = SHA2_LoadBE64(bufferPtr + 44);
+    uint32_t messageBlockByteCount = SHA2_LoadBE32(bufferPtr + 52);
+
+    // Note (Aaron): Whole bytes are hashed, and the buffered bytes are always the message tail
+    // that does not fill a block
+    if (memcmp(bufferPtr, "S256", 4) != 0
+        || SHA2_LoadBE32(bufferPtr + 4) != SHA2_STATE_FORMAT_VERSION
+        || (digestLength != SHA2_DIGEST_LENGTH_SHA224 && digestLength != SHA2_DIGEST_LENGTH_SHA256)
+        || (messageLengthBits % 8) != 0
+        || messageBlockByteCount != (messageLengthBits / 8) % SHA2_MESSAGE_BLOCK_SIZE_SHA256)
+    {
+        return SHA2_RESULT_INVALID_STATE;
+    }
+
+    if (digestLength == SHA2_DIGEST_LENGTH_SHA224)
+    {
+        SHA2_InitializeStateSHA224(state);
+    }
+    else
+    {
+        SHA2_InitializeStateSHA256(state);
+    }
+
+    for (int i = 0; i < 8; ++i)
+    {
+        state->H[i] = SHA2_LoadBE32(bufferPtr + 12 + (i * 4));
+    }
+
+    state->MessageLengthBits = messageLengthBits;
+    state->MessageBlockByteCount = messageBlockByteCount;
+    if (messageBlockByteCount > 0)
+    {
+        SHA2_MemoryCopy(state->MessageBlock, bufferPtr + 56, messageBlockByteCount);
+    }
+
+    return SHA2_RESULT_OK;
+}
+
+
+void SHA2_ExportStateSHA512(sha2_512_hash const *state, uint8_t *bufferPtr)
+{
+    sha2_assert(state->MessageBlockByteCount < SHA2_MESSAGE_BLOCK_SIZE_SHA512);
+
+    SHA2_MemoryCopy(bufferPtr, "S512", 4);
+    SHA2_StoreBE32(bufferPtr + 4, SHA2_STATE_FORMAT_VERSION);
+    SHA2_StoreBE32(bufferPtr + 8, state->DigestLength);
+
+    for (int i = 0; i < 8; ++i)
+    {
+        SHA2_StoreBE64(bufferPtr + 12 + (i * 8), state->H[i]);
+    }
+
+    SHA2_StoreBE64(bufferPtr + 76, state->MessageLengthBits.High);
+    SHA2_StoreBE64(bufferPtr + 84, state->MessageLengthBits.Low);
+    SHA2_StoreBE32(bufferPtr + 92, state->MessageBlockByteCount);
+
+    uint8_t *blockPtr = bufferPtr + 96;
+    SHA2_MemorySet(blockPtr, 0, SHA2_MESSAGE_BLOCK_SIZE_SHA512);
+    if (state->MessageBlockByteCount > 0)
+    {
+        SHA2_MemoryCopy(blockPtr, state->MessageBlock, state->MessageBlockByteCount);
+    }
+}
+
+sha2_result SHA2_ImportStateSHA512(sha2_512_hash *state, uint8_t const *bufferPtr)
+{
+    uint32_t digestLength = SHA2_LoadBE32(bufferPtr + 8);
+    uint64_t messageLengthBitsHigh = SHA2_LoadBE64(bufferPtr + 76);
+    uint64_t messageLengthBitsLow = SHA2_LoadBE64(bufferPtr + 84);
+    uint32_t messageBlockByteCount = SHA2_LoadBE32(bufferPtr + 92);
+
+    // Note (Aaron): The low half of the message length alone determines the size of the tail. The
+    // high half stays below 8 because updates stop at 2^64 - 1 message bytes.
+    if (memcmp(bufferPtr, "S512", 4) != 0
+        || SHA2_LoadBE32(bufferPtr + 4) != SHA2_STATE_FORMAT_VERSION
+        || messageLengthBitsHigh >= 8
+        || (messageLengthBitsLow % 8) != 0
+        || messageBlockByteCount != (messageLengthBitsLow / 8) % SHA2_MESSAGE_BLOCK_SIZE_SHA512)
+    {
+        return SHA2_RESULT_INVALID_STATE;
+    }
+
+    switch (digestLength)
+    {
+        case SHA2_DIGEST_LENGTH_SHA224:
+        {
+            SHA2_InitializeStateSHA512_224(state);
+            break;
+        }
+        case SHA2_DIGEST_LENGTH_SHA256:
+        {
+            SHA2_InitializeStateSHA512_256(state);
+            break;
+        }
+        case SHA2_DIGEST_LENGTH_SHA384:
+        {
+            SHA2_InitializeStateSHA384(state);
+            break;
+        }
+        case SHA2_DIGEST_LENGTH_SHA512:
+        {
+            SHA2_InitializeStateSHA512(state);
+            break;
+        }
+        default:
+        {
+            return SHA2_RESULT_INVALID_STATE;
+        }
+    }
+
+    for (int i = 0; i < 8; ++i)
+    {
+        state->H[i] = SHA2_LoadBE64(bufferPtr + 12 + (i * 8));
+    }
+
+    state->MessageLengthBits.High = messageLengthBitsHigh;
+    state->MessageLengthBits.Low = messageLengthBitsLow;
+    state->MessageBlockByteCount = messageBlockByteCount;
+    if (messageBlockByteCount > 0)
+    {
+        SHA2_MemoryCopy(state->MessageBlock, bufferPtr + 96, messageBlockByteCount);
+    }
+
+    return SHA2_RESULT_OK;
 }
 
 
@@ -1,6 +1,6 @@
 /*  test-shared-library.c
 
-    Test driver for ensuring the usage of md5.h, sha1.h and sha2.h as DLLs.
+    Test driver for ensuring the usage of md5.h, sha1.h and sha2.h as DLLs and shared libraries.
 */
 
 #include "md5.h"
@@ -9,10 +9,24 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
 
+#if defined(_MSC_VER)
 #pragma comment (lib, "md5.lib")
 #pragma comment (lib, "sha1.lib")
 #pragma comment (lib, "sha2.lib")
+#endif
+
+static int FailedCount = 0;
+
+static void CheckDigest(char const *digestStr, char const *expectedDigestStr)
+{
+    if (strcmp(digestStr, expectedDigestStr) != 0)
+    {
+        printf("FAILED: expected %s\n", expectedDigestStr);
+        ++FailedCount;
+    }
+}
 
 int main(int argc, char const *argv[])
 {
@@ -22,28 +36,34 @@ int main(int argc, char const *argv[])
 
     uint32_t md5Version = MD5_GetVersion();
     printf("md5.h version: %i\n", md5Version);
+    printf("md5 kernel: %s\n", MD5_GetKernelName());
 
     messagePtr = (char *)"abcde";
     md5_context md5Context = MD5_HashString(messagePtr);
-    printf("sha1 digest for 'abcde': %s\n", md5Context.DigestStr);
+    printf("md5 digest for 'abcde': %s\n", md5Context.DigestStr);
+    CheckDigest(md5Context.DigestStr, "ab56b4d92b40713acc5af89985d4b786");
     printf("\n");
 
 
     uint32_t sha1Version = SHA1_GetVersion();
     printf("sha1.h version: %i\n", sha1Version);
+    printf("sha1 kernel: %s\n", SHA1_GetKernelName());
 
     messagePtr = (char *)"abcde";
     sha1_context sha1Context = SHA1_HashString(messagePtr);
     printf("sha1 digest for 'abcde': %s\n", sha1Context.DigestStr);
+    CheckDigest(sha1Context.DigestStr, "03de6c570bfe24bfc328ccd7ca46b76eadaf4334");
     printf("\n");
 
     uint32_t sha2Version = SHA2_GetVersion();
     printf("sha2.h version: %i\n", sha2Version);
+    printf("sha256 kernel: %s\n", SHA2_GetKernelNameSHA256());
 
     messagePtr = (char *)"abcde";
     sha2_256_context sha256Context = SHA2_HashStringSHA256(messagePtr);
     printf("sha256 digest for 'abcde': %s\n", sha256Context.DigestStr);
+    CheckDigest(sha256Context.DigestStr, "36bbe50ed96841d10443bcb670d6554f0a34b761be67ec9c4a8ad2c0c44ca42c");
     printf("\n");
 
-    return 0;
+    return FailedCount ? 1 : 0;
 }